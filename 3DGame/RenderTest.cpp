@@ -93,12 +93,10 @@ IRenderable* six;
 
 void setupRendering(IRenderer* renderer)
 {
-	createTexture("test_resources/textures/road.png", false, "road");
-	createTexture("test_resources/textures/car1.png", false, "car1");
-	createTexture("test_resources/textures/car2.png", false, "car2");
-	createTexture("test_resources/textures/car3.png", false, "car3");
-	createTexture("test_resources/textures/car4.png", false, "car4");
-	createTexture("test_resources/textures/car5.png", false, "car5");
+	//all six in one go so they can share texture arrays and the materials draw without rebinding
+	createTextures({ "test_resources/textures/road.png", "test_resources/textures/car1.png", "test_resources/textures/car2.png",
+		"test_resources/textures/car3.png", "test_resources/textures/car4.png", "test_resources/textures/car5.png" },
+		false, { "road", "car1", "car2", "car3", "car4", "car5" });
 	Mesh* plane = loadMesh("test_resources/models/plane.ob", "plane");
 	Mesh* addhash = loadMesh("test_resources/models/monkey.ob", "monkey");
 	Material* pretty = new Material(retrieveTexture("car1"));
@@ -277,6 +275,7 @@ int main()
 			renderer->getCamera()->setCameraRotation(glm::normalize(glm::angleAxis(pitch, vec3(1, 0, 0)) * glm::angleAxis(yaw, vec3(0, 1, 0))));
 		}
 		auto millis = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::system_clock::now().time_since_epoch()).count();
+		pollInput();
 		tickCore(1);
 		renderer->renderAndSwap();
 		//renderer->editText(textID, std::to_string(millis - pt));
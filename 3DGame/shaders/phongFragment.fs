@@ -1,10 +1,15 @@
 #version 330 
 precision highp float;
 
-const int MAX_POINT_LIGHTS = 25;
+//dependant on LightClusters.h
+const int CLUSTER_GRID_X = 16;
+const int CLUSTER_GRID_Y = 9;
+const int CLUSTER_GRID_Z = 24;
 
 in vec3 worldPos;
 in vec2 texCoord;
+flat in vec4 texRect;
+flat in float texLayer;
 in vec3 normalCoord; //**
 in vec3 Normal;
 
@@ -36,14 +41,26 @@ struct PointLight
 	vec3 position;
 };
 
-uniform vec4 baseColor;
-uniform vec4 ambientLight;
-uniform sampler2D diffuseTexture;
+//uploaded once per frame, dependant on LightBlock in PhongShader.h
+layout (std140) uniform Lights
+{
+	vec4 ambientLight;
+	vec4 directionalColor;
+	vec4 directionalDirection; //w = intensity
+	vec4 cameraPosition; //xyz
+	vec4 viewDepth; //dot(viewDepth, vec4(worldPos, 1)) is the view space depth
+	vec4 clusterScale; //pixels to tiles (xy), log depth to slice (z scale, w bias)
+};
 
-uniform DirectionalLight directionalLight;
-uniform PointLight pointLights[MAX_POINT_LIGHTS];
+//binned on the cpu every frame, dependant on LightClusters.h
+uniform samplerBuffer pointLights; //3 texels per light: color, position + intensity, attenuation + radius
+uniform usamplerBuffer lightClusters; //first index, count
+uniform usamplerBuffer lightIndices;
+
+uniform vec4 baseColor;
+uniform sampler2DArray diffuseTexture;
+uniform float textureLodScale; //exp2 of the mip bias, scales the gradients below
 
-uniform vec3 cameraPosition;
 uniform float specularIntensity;
 uniform float specularPower;
 
@@ -58,7 +75,7 @@ vec4 calcLight(BaseLight base, vec3 direction, vec3 normal)
 	{
 		diffuseColor = base.color * base.intensity * diffuseFactor;
 
-		vec3 directionToEye = normalize(cameraPosition - worldPos);
+		vec3 directionToEye = normalize(cameraPosition.xyz - worldPos);
 		vec3 reflectDirection = normalize(reflect(direction, normal));
 
 		float specularFactor = dot(directionToEye, reflectDirection);
@@ -91,7 +108,25 @@ vec4 calcPointLight(PointLight pointLight, vec3 normal)
 						 pointLight.attenuation.linear * distanceToPoint + 
 						 pointLight.attenuation.quadratic * distanceToPoint * distanceToPoint
 						 + 0.0001;
-	return 15.0f * color / attenuation; 
+	return 15.0f * color / attenuation; //15 dependant on LightClusters.cpp
+}
+
+//fades to nothing at the radius the light was binned with so cluster edges never show
+float pointLightWindow(vec3 position, float radius)
+{
+	float ratio = distance(worldPos, position) / radius;
+	float window = clamp(1.0f - ratio * ratio * ratio * ratio, 0.0f, 1.0f);
+	return window * window;
+}
+
+int findCluster()
+{
+	ivec2 tile = ivec2(gl_FragCoord.xy * clusterScale.xy);
+	float depth = dot(viewDepth, vec4(worldPos, 1.0f));
+	int slice = int(log(max(depth, 0.0001f)) * clusterScale.z + clusterScale.w);
+	tile = clamp(tile, ivec2(0), ivec2(CLUSTER_GRID_X - 1, CLUSTER_GRID_Y - 1));
+	slice = clamp(slice, 0, CLUSTER_GRID_Z - 1);
+	return (slice * CLUSTER_GRID_Y + tile.y) * CLUSTER_GRID_X + tile.x;
 }
 
 uniform samplerCube skybox;
@@ -108,24 +143,36 @@ void main()
 	{
 		vec4 totalLight = ambientLight;
 		vec4 color = baseColor;
-		vec4 textureColor = texture(diffuseTexture, texCoord.xy);
+		//wrapped by hand so repeating uvs stay inside atlased images, gradients from the unwrapped uvs keep seams out of the mip selection
+		vec2 atlasCoord = texRect.xy + fract(texCoord) * texRect.zw;
+		vec4 textureColor = textureGrad(diffuseTexture, vec3(atlasCoord, texLayer), dFdx(texCoord) * texRect.zw * textureLodScale, dFdy(texCoord) * texRect.zw * textureLodScale);
 
 		if(textureColor != vec4(0.0f, 0.0f, 0.0f, 0.0f))
 			color *= textureColor;
 	
 		vec3 normal = normalize(normalCoord); //TODO: gaureentte its already normalized, so in the future take out this code
 
+		DirectionalLight directionalLight = DirectionalLight(BaseLight(directionalColor, directionalDirection.w), directionalDirection.xyz);
 		totalLight += calcDirectionalLight(directionalLight, normal);
 
-		for(int i = 0; i < MAX_POINT_LIGHTS; i++)
-			totalLight += calcPointLight(pointLights[i], normal);
+		//only the lights binned into this pixel's cluster
+		uvec2 cluster = texelFetch(lightClusters, findCluster()).xy;
+		for(uint i = 0u; i < cluster.y; i++)
+		{
+			int light = int(texelFetch(lightIndices, int(cluster.x + i)).r) * 3;
+			vec4 color = texelFetch(pointLights, light);
+			vec4 position = texelFetch(pointLights, light + 1);
+			vec4 attenuation = texelFetch(pointLights, light + 2);
+			PointLight pointLight = PointLight(BaseLight(color, position.w), Attenuation(attenuation.x, attenuation.y, attenuation.z), position.xyz);
+			totalLight += calcPointLight(pointLight, normal) * pointLightWindow(position.xyz, attenuation.w);
+		}
 
 		diffuse_color = color * totalLight;
 	}
 
 	if(refractiveIndex >= 0.0f)
 	{
-		vec3 Incident = normalize(worldPos - cameraPosition);
+		vec3 Incident = normalize(worldPos - cameraPosition.xyz);
 		vec3 R;
 		if(refractiveIndex > 1.0f) 
 			R = refract(Incident, normalize(Normal), 1.0f/refractiveIndex);
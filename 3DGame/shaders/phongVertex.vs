@@ -4,19 +4,25 @@ precision highp float;
 layout (location = 0) in vec3 position;
 layout (location = 1) in vec2 texture;
 layout (location = 2) in vec3 normal;
+layout (location = 3) in mat4 model; //per instance, takes locations 3 to 6
+layout (location = 7) in vec4 uvRect; //per instance, offset xy, scale zw into the texture array
+layout (location = 8) in float layer; //per instance
 
 out vec2 texCoord;
+flat out vec4 texRect;
+flat out float texLayer;
 out vec3 normalCoord;
 out vec3 worldPos;
 out vec3 Normal;
 
-uniform mat4 transform;
-uniform mat4 model;
+uniform mat4 transform; //projection * view
 
 void main()
 {
-	gl_Position = transform * vec4(position, 1.0f);
+	gl_Position = transform * model * vec4(position, 1.0f);
 	texCoord = texture;
+	texRect = uvRect;
+	texLayer = layer;
 	normalCoord = (model * vec4(normal, 0.0)).xyz;
 	worldPos = (model * vec4(position, 1.0)).xyz;
 	Normal = mat3(transpose(inverse(model))) * normal;
@@ -4,8 +4,10 @@ layout (location = 1) in vec2 texCoords;
 
 out vec2 TexCoords;
 
+uniform vec2 uvScale; //the part of the texture the scene was rendered into, see ScreenBuffer::setRenderScale
+
 void main()
 {
     gl_Position = vec4(position.x, position.y, 0.0f, 1.0f); 
-    TexCoords = texCoords;
+    TexCoords = texCoords * uvScale;
 }  
\ No newline at end of file
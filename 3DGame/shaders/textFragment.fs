@@ -1,12 +1,15 @@
 #version 330 core
 in vec2 TexCoords;
+in vec3 textColor;
 out vec4 color;
 
-uniform sampler2D text;
-uniform vec3 textColor;
+uniform sampler2D text; //signed distance field, 0.5 on the outline
 
 void main()
 {    
-    vec4 sampled = vec4(1.0, 1.0, 1.0, texture(text, TexCoords).r);
-    color = vec4(textColor, 1.0) * sampled;
+    float distance = texture(text, TexCoords).r;
+    //about a pixel of antialiasing at any scale
+    float width = fwidth(distance);
+    float alpha = smoothstep(0.5 - width, 0.5 + width, distance);
+    color = vec4(textColor, alpha);
 }  
\ No newline at end of file
@@ -25,6 +25,7 @@ namespace ginkgo
 		movementState = 0;
 		
 		inputSystem = createUserInputSystem();
+		inputSystem->setOwner(this);
 
 		inputSystem->addCommand(CommandSetReset(1, [](IAbstractInputSystem* inputSystem, int outputCode, bool set)
 		{
@@ -76,7 +77,7 @@ namespace ginkgo
 		inputSystem->bindInputCode(GLFW_KEY_A, 3);
 		inputSystem->bindInputCode(GLFW_KEY_D, 4);
 
-		registerInputSystem(inputSystem, this);
+		//not registered with the core until something possesses this character (see possessCharacter)
 	}
 
 	void Character::beginTick(float elapsedTime)
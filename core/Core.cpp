@@ -13,6 +13,8 @@
 #include <vector>
 #include "MovementStateCallbackManager.h"
 #include "Character.h"
+#include <IRenderer.h>
+#include <RenderSnapshot.h>
 
 namespace ginkgo
 {
@@ -42,6 +44,7 @@ namespace ginkgo
 	Core::Core()
 	{
 		running = false;
+		possessedInput = nullptr;
 		tickTime = (1.f / 60.f);
 		startTick = GetTickCount64();
 		world = new World(-9.8f);
@@ -76,9 +79,14 @@ namespace ginkgo
 		}
 	}
 
-	void Core::processInput()
+	void Core::pollInput()
 	{
 		glfwPollEvents();
+	}
+
+	void Core::processInput()
+	{
+		drainInputEvents(possessedInput);
 		
 		for (IAbstractInputSystem* input : inputSystemList)
 		{
@@ -143,11 +151,22 @@ namespace ginkgo
 
 		world->resolveCollisions(16);
 
+		//render components fill in the snapshot during endTick
+		IRenderer* renderer = getRendererInstance();
+		if (renderer != nullptr)
+		{
+			renderer->beginSnapshot();
+		}
 
 		for (IEntity* e : entityList)
 		{
 			e->endTick(elapsedTime);
 		}
+
+		if (renderer != nullptr)
+		{
+			renderer->publishSnapshot();
+		}
 		world->checkMovementStates(elapsedTime);
 		world->doMovementStates(elapsedTime);
 
@@ -170,6 +189,15 @@ namespace ginkgo
 	{
 		input->setOwner(controller);
 		core.inputSystemList.emplace_back(input);
+		if (core.possessedInput == nullptr)
+		{
+			core.possessedInput = input;
+		}
+	}
+
+	void Core::possessInputSystem(IAbstractInputSystem* input)
+	{
+		core.possessedInput = input;
 	}
 
 	//~~~~~~~~~~~~~~~~~~~~~~~
@@ -204,6 +232,11 @@ namespace ginkgo
 		return Core::core.getWorld();
 	}
 
+	void pollInput()
+	{
+		Core::core.pollInput();
+	}
+
 	void tickCore(float ts)
 	{
 		Core::core.coreTick(ts);
@@ -224,6 +257,27 @@ namespace ginkgo
 		return Core::core.getInputSystemList();
 	}
 
+	void possessInputSystem(IAbstractInputSystem* input)
+	{
+		Core::possessInputSystem(input);
+	}
+
+	void possessCharacter(ICharacter* character)
+	{
+		IAbstractInputSystem* input = character->getInputSystem();
+		bool registered = false;
+		for (IAbstractInputSystem* s : Core::core.getInputSystemList())
+		{
+			registered |= (s == input);
+		}
+		//characters don't register their own input systems, so run it once it's in control
+		if (!registered)
+		{
+			Core::registerInputSystem(input, character);
+		}
+		Core::possessInputSystem(input);
+	}
+
 	int registerMovementState(const std::string& name, const CheckIfMovementState& CheckMovementState, const DoOnMovementState& OnMovementState, const OnMovementStateEnabled& OnStateEnabled, const OnMovementStateDisabled& OnStateDisabled)
 	{
 		IWorld* world = getWorld();
@@ -32,6 +32,8 @@ namespace ginkgo
 		MovementStateCallbackManager manager;
 
 		vector<IAbstractInputSystem*> inputSystemList;
+		//the only input system that receives raw user input
+		IAbstractInputSystem* possessedInput;
 
 	public:
 		static Core core;
@@ -45,6 +47,7 @@ namespace ginkgo
 		void coreTick(float timeScale);
 		void physicsTick(float elapsedTime);
 
+		void pollInput();
 		void processInput();
 		void sleep();
 
@@ -60,6 +63,7 @@ namespace ginkgo
 		static void stopCore();
 		static void setupInput(GLFWwindow* window);
 		static void registerInputSystem(IAbstractInputSystem* input, ICharacter* controller);
+		static void possessInputSystem(IAbstractInputSystem* input);
 
 	};
 #endif
@@ -70,12 +74,18 @@ namespace ginkgo
 	DECLSPEC_CORE void stopCore();
 	DECLSPEC_CORE IWorld* getWorld();
 
+	//pumps window events into the input queue, call from the thread that owns the window
+	DECLSPEC_CORE void pollInput();
 	DECLSPEC_CORE void tickCore(float timeScale);
 
 	DECLSPEC_CORE void sleepTickTime();
 
 	DECLSPEC_CORE void registerInputSystem(IAbstractInputSystem* input, ICharacter* controller);
 	DECLSPEC_CORE vector<IAbstractInputSystem*> const& getAllInputSystems();
+	//route user input to this system (registered systems are possessed automatically if nothing else is)
+	DECLSPEC_CORE void possessInputSystem(IAbstractInputSystem* input);
+	//route user input to the character's own input system
+	DECLSPEC_CORE void possessCharacter(ICharacter* character);
 
 	DECLSPEC_CORE int registerMovementState(const std::string& name, const CheckIfMovementState& CheckMovementState, const DoOnMovementState& OnMovementState, const OnMovementStateEnabled& OnStateEnabled, const OnMovementStateDisabled& OnStateDisabled);
 	DECLSPEC_CORE int getMovementState(const std::string& name);
@@ -259,6 +259,8 @@ namespace ginkgo
 
 #define OUTCODE_INVALID -1
 #define INCODE_MOUSE -1
+//input codes from INCODE_MOUSE up to (but not including) INCODE_MOUSE + INCODE_TABLE_SIZE can be bound (covers every glfw key)
+#define INCODE_TABLE_SIZE 512
 
 	struct Command
 	{
@@ -311,6 +313,7 @@ namespace ginkgo
 
 			isSet = false;
 			prevSet = false;
+			timestamp = 0;
 		}
 
 		~CommandState()
@@ -320,6 +323,8 @@ namespace ginkgo
 
 		bool isSet;
 		bool prevSet;
+		//when the input that last touched this state was received (steady clock nanoseconds)
+		long long timestamp;
 		Command* command;
 	};
 };
\ No newline at end of file
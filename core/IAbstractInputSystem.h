@@ -24,6 +24,7 @@ namespace ginkgo
 		virtual ICharacter* getOwner() = 0;
 
 		virtual Command* onInputCode(Bind const& input, bool set) = 0;
+		virtual Command* onRawInput(int inputCode, bool set, long long timestamp) = 0;
 		virtual void runInput() = 0;
 
 		virtual Bind const& getControl(int inputState) = 0;
@@ -7,6 +7,7 @@
 namespace ginkgo
 {
 	class IEntity;
+	class ICharacter;
 	class Octree;
 	struct Collision;
 
@@ -15,6 +16,7 @@ namespace ginkgo
 	public:
 		virtual vector<IEntity*> getEntitiesByType(EntityType type) const = 0;
 		virtual const vector<IEntity*>& getEntityList() const = 0;
+		virtual const vector<ICharacter*>& getCharacterList() const = 0;
 
 		virtual void clearWorld() = 0;
 
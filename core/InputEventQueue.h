@@ -0,0 +1,76 @@
+#pragma once
+
+#include "CoreReource.h"
+#include <atomic>
+#include <chrono>
+
+namespace ginkgo
+{
+	enum InputEventType
+	{
+		INPUTEVENT_KEY,
+		INPUTEVENT_MOUSEBUTTON,
+		INPUTEVENT_MOUSEMOVE,
+	};
+
+	//raw input as it came off the window, stamped when it was received
+	struct InputEvent
+	{
+		InputEventType type;
+		int code;
+		int action;
+		double x, y;
+		//nanoseconds on the steady clock
+		long long timestamp;
+
+		static long long now()
+		{
+			return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+		}
+	};
+
+	//single producer (window thread), single consumer (core thread) ring buffer
+	//no locks: the producer only writes tail, the consumer only writes head
+	class InputEventQueue
+	{
+	public:
+		//must be a power of 2
+		static const UINT32 CAPACITY = 1024;
+
+	private:
+		InputEvent events[CAPACITY];
+		std::atomic<UINT32> head;
+		std::atomic<UINT32> tail;
+
+	public:
+		InputEventQueue()
+			: head(0), tail(0)
+		{}
+
+		//producer side, returns false (and drops the event) if the consumer has fallen a full buffer behind
+		bool push(InputEvent const& e)
+		{
+			UINT32 t = tail.load(std::memory_order_relaxed);
+			if (t - head.load(std::memory_order_acquire) == CAPACITY)
+			{
+				return false;
+			}
+			events[t & (CAPACITY - 1)] = e;
+			tail.store(t + 1, std::memory_order_release);
+			return true;
+		}
+
+		//consumer side
+		bool pop(InputEvent& out)
+		{
+			UINT32 h = head.load(std::memory_order_relaxed);
+			if (h == tail.load(std::memory_order_acquire))
+			{
+				return false;
+			}
+			out = events[h & (CAPACITY - 1)];
+			head.store(h + 1, std::memory_order_release);
+			return true;
+		}
+	};
+}
@@ -1,51 +1,51 @@
-
 #include "InputWrapper.h"
 #include "Core.h"
 #include "IAbstractInputSystem.h"
+#include "InputEventQueue.h"
 #ifndef _WIN64
 #include <GLFW\glfw3.h>
+#include <atomic>
+#include <iostream>
 
 namespace ginkgo
 {
-	void setKeyCallback(GLFWwindow* window, int key, int sc, int action, int mod)
+	//written by the glfw callbacks, read by the core tick
+	static InputEventQueue rawInput;
+	//events push had to drop, reported from the core thread so the callbacks stay cheap
+	static std::atomic<unsigned int> droppedInput(0);
+	static unsigned int reportedDroppedInput = 0;
+
+	static void pushInputEvent(InputEventType type, int code, int action, double x = 0, double y = 0)
 	{
-		for (IAbstractInputSystem* s : getAllInputSystems())
+		InputEvent e;
+		e.type = type;
+		e.code = code;
+		e.action = action;
+		e.x = x;
+		e.y = y;
+		e.timestamp = InputEvent::now();
+		if (!rawInput.push(e))
 		{
-			Bind const& ctl = s->getControl(key);
-			if (ctl.inputType == INPUTTYPE_USER && action != GLFW_REPEAT)
-			{
-				s->onInputCode(ctl, action == GLFW_PRESS);
-			}
+			droppedInput.fetch_add(1, std::memory_order_relaxed);
 		}
 	}
 
-	void setMouseButtonCallback(GLFWwindow* window, int button, int action, int mod)
+	void setKeyCallback(GLFWwindow* window, int key, int sc, int action, int mod)
 	{
-		for (IAbstractInputSystem * s : getAllInputSystems())
+		if (action != GLFW_REPEAT)
 		{
-			Bind const& ctl = s->getControl(button);
-			if (ctl.inputType == INPUTTYPE_USER)
-			{
-				s->onInputCode(ctl, action == GLFW_PRESS);
-			}
+			pushInputEvent(INPUTEVENT_KEY, key, action);
 		}
 	}
 
+	void setMouseButtonCallback(GLFWwindow* window, int button, int action, int mod)
+	{
+		pushInputEvent(INPUTEVENT_MOUSEBUTTON, button, action);
+	}
+
 	void setMouseMoveCallback(GLFWwindow* window, double x, double y)
 	{
-		for (IAbstractInputSystem* s : getAllInputSystems())
-		{
-			Bind const& ctl = s->getControl(INCODE_MOUSE);
-			if (ctl.inputType == INPUTTYPE_USER)
-			{
-				Command2f* cmd = (Command2f*)s->onInputCode(ctl, true);
-				if (cmd != nullptr)
-				{
-					cmd->a = x;
-					cmd->b = y;
-				}
-			}
-		}
+		pushInputEvent(INPUTEVENT_MOUSEMOVE, INCODE_MOUSE, GLFW_PRESS, x, y);
 	}
 
 	void registerCallbacks(GLFWwindow* window)
@@ -54,6 +54,47 @@ namespace ginkgo
 		glfwSetMouseButtonCallback(window, setMouseButtonCallback);
 		glfwSetCursorPosCallback(window, setMouseMoveCallback);
 	}
+
+	unsigned int getDroppedInputCount()
+	{
+		return droppedInput.load(std::memory_order_relaxed);
+	}
+
+	void drainInputEvents(IAbstractInputSystem* target)
+	{
+		unsigned int dropped = droppedInput.load(std::memory_order_relaxed);
+		if (dropped != reportedDroppedInput)
+		{
+			std::cout << "Input queue full, dropped " << (dropped - reportedDroppedInput) << " events (" << dropped << " total)" << std::endl;
+			reportedDroppedInput = dropped;
+		}
+
+		InputEvent e;
+		while (rawInput.pop(e))
+		{
+			if (target == nullptr)
+			{
+				continue;
+			}
+			switch (e.type)
+			{
+			case INPUTEVENT_KEY:
+			case INPUTEVENT_MOUSEBUTTON:
+				target->onRawInput(e.code, e.action == GLFW_PRESS, e.timestamp);
+				break;
+			case INPUTEVENT_MOUSEMOVE:
+			{
+				Command* cmd = target->onRawInput(INCODE_MOUSE, true, e.timestamp);
+				if (cmd != nullptr && cmd->type == FLOAT_2)
+				{
+					((Command2f*)cmd)->a = (float)e.x;
+					((Command2f*)cmd)->b = (float)e.y;
+				}
+			}
+			break;
+			}
+		}
+	}
 }
 #else
 namespace ginkgo
@@ -62,5 +103,15 @@ namespace ginkgo
 	{
 		//do nothing
 	}
+
+	void drainInputEvents(IAbstractInputSystem* target)
+	{
+		//do nothing
+	}
+
+	unsigned int getDroppedInputCount()
+	{
+		return 0;
+	}
 }
-#endif
\ No newline at end of file
+#endif
@@ -4,5 +4,12 @@ struct GLFWwindow;
 
 namespace ginkgo
 {
+	class IAbstractInputSystem;
+
 	void registerCallbacks(GLFWwindow* window);
-}
\ No newline at end of file
+
+	//dispatches everything captured since the last call to target (nullptr just discards it)
+	void drainInputEvents(IAbstractInputSystem* target);
+	//events lost because the queue was full, each new loss is also printed by drainInputEvents
+	unsigned int getDroppedInputCount();
+}
@@ -3,6 +3,7 @@
 
 namespace ginkgo {
 	MovementStateCallbackManager::MovementStateCallbackManager()
+		: bucketsValid(false)
 	{
 		RegisteredMovementState fallingState("FallingMovementState", [](const ICharacter&, float) { return false; }, resolveFreemove, [](ICharacter&, float) { return; }, [](ICharacter&, float) { return; });
 		this->RegisterMovementState(fallingState);
@@ -18,6 +19,8 @@ namespace ginkgo {
 	int MovementStateCallbackManager::RegisterMovementState(const RegisteredMovementState & state)
 	{
 		this->states.push_back(state);
+		this->stateBuckets.resize(this->states.size());
+		bucketsValid = false;
 		return this->states.size() - 1;
 	}
 
@@ -41,47 +44,71 @@ namespace ginkgo {
 		return this->states.at(ID);
 	}
 
-	void MovementStateCallbackManager::CheckMovementStates(const std::vector<IEntity*>& entities, float elapsedTime)
+	void MovementStateCallbackManager::SwitchMovementState(ICharacter& character, int newState, float elapsedTime)
 	{
-		for (IEntity* entity : entities) {
-			ICharacter* character = dynamic_cast<ICharacter*>(entity);
-			if (character == nullptr) continue;
-			bool stateFound = false;
+		int oldState = character.getMovementState();
+		if (oldState != newState)
+		{
+			states.at(oldState).OnStateDisabled(character, elapsedTime);
+			states.at(newState).OnStateEnabled(character, elapsedTime);
+		}
+		character.setMovementState(newState);
+	}
+
+	void MovementStateCallbackManager::CheckMovementStates(const std::vector<ICharacter*>& characters, float elapsedTime)
+	{
+		for (std::vector<ICharacter*>& bucket : stateBuckets)
+		{
+			bucket.clear();
+		}
+
+		for (ICharacter* character : characters) {
+			int newState = 0;
 			//TODO: ignore world static objects
 			//character->setMovementState(0); JASON?????
-			for (std::vector<int>::size_type i = 0; i < character->getMovementStates().size(); ++i) {
-				const RegisteredMovementState& state = this->states.at(i);
-				if (state.CheckMovementState(*character, elapsedTime)) 
+			for (int stateID : character->getMovementStates()) {
+				if (this->states.at(stateID).CheckMovementState(*character, elapsedTime))
 				{
-					if (state.name.compare(states.at(character->getMovementState()).name) != 0)
-					{
-						states.at(character->getMovementState()).OnStateDisabled(*character, elapsedTime);
-						state.OnStateEnabled(*character, elapsedTime);
-					}
-					character->setMovementState(i);
-					stateFound = true;
+					newState = stateID;
 					break;
 				}
 			}
 
-			if (!stateFound)
-			{
-				if (states.at(0).name.compare(states.at(character->getMovementState()).name) != 0)
-				{
-					states.at(character->getMovementState()).OnStateDisabled(*character, elapsedTime);
-					states.at(0).OnStateEnabled(*character, elapsedTime);
-				}
-				character->setMovementState(0);
-			}
+			SwitchMovementState(*character, newState, elapsedTime);
+			stateBuckets[newState].emplace_back(character);
 		}
+		bucketsValid = true;
 	}
 
-	void MovementStateCallbackManager::DoCallbacks(const std::vector<IEntity*>& entities, float elapsedTime)
+	void MovementStateCallbackManager::GroupByState(const std::vector<ICharacter*>& characters)
 	{
-		for (IEntity* entity : entities) {
-			ICharacter* character = dynamic_cast<ICharacter*>(entity);
-			if (character == nullptr) continue;
-			this->states.at(character->getMovementState()).OnMovementState(*character, elapsedTime); //masking?
+		for (std::vector<ICharacter*>& bucket : stateBuckets)
+		{
+			bucket.clear();
+		}
+		for (ICharacter* character : characters)
+		{
+			stateBuckets.at(character->getMovementState()).emplace_back(character);
+		}
+		bucketsValid = true;
+	}
+
+	void MovementStateCallbackManager::DoCallbacks(const std::vector<ICharacter*>& characters, float elapsedTime)
+	{
+		if (!bucketsValid)
+		{
+			GroupByState(characters);
+		}
+
+		//resolve each state's callback once and run it over every character in that state
+		for (size_t i = 0; i < stateBuckets.size(); ++i) {
+			const std::vector<ICharacter*>& bucket = stateBuckets[i];
+			if (bucket.empty()) continue;
+
+			const DoOnMovementState& onMovementState = this->states[i].OnMovementState; //masking?
+			for (ICharacter* character : bucket) {
+				onMovementState(*character, elapsedTime);
+			}
 		}
 	}
 
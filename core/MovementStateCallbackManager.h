@@ -11,7 +11,7 @@ exempting certain entities from callbacks
 */
 
 namespace ginkgo {
-	class IEntity;
+	class ICharacter;
 
 	class MovementStateCallbackManager {
 	public:
@@ -21,13 +21,22 @@ namespace ginkgo {
 		int GetMovementStateID(const std::string& state_name) const;
 		RegisteredMovementState& GetMovementState(int ID);
 		const RegisteredMovementState& GetMovementState(int ID) const;
-		void CheckMovementStates(const std::vector<IEntity*>& entities, float elapsedTime);
-		void DoCallbacks(const std::vector<IEntity*>& entities, float elapsedTime);
+		void CheckMovementStates(const std::vector<ICharacter*>& characters, float elapsedTime);
+		void DoCallbacks(const std::vector<ICharacter*>& characters, float elapsedTime);
 		std::vector<RegisteredMovementState> GetRegisteredMovementStates() const;
 
+		//call when the character list changes so stale buckets are not dispatched
+		void InvalidateStateBuckets() { bucketsValid = false; }
 
 	private:
+		void SwitchMovementState(ICharacter& character, int newState, float elapsedTime);
+		void GroupByState(const std::vector<ICharacter*>& characters);
+
 		std::vector<RegisteredMovementState> states;
+
+		//characters grouped by their current movement state (indexed by state ID)
+		std::vector<std::vector<ICharacter*>> stateBuckets;
+		bool bucketsValid;
 	};
 }
 
@@ -3,44 +3,43 @@
 #include <IRenderable.h>
 #include <ITransform.h>
 #include <IRenderer.h>
+#include <RenderSnapshot.h>
 
 namespace ginkgo
 {
 	RenderComponent::RenderComponent(IEntity* parent, IRenderable* mesh) 
-		: parent(parent)
+		: mesh(mesh), UID(mesh->getIndex()), parent(parent), position(parent->getPosition()), rotation(parent->getRotation()), scale(1, 1, 1)
 	{
-		this->mesh = mesh;
-		setRotation(parent->getRotation());
 	}
 
 	const vec3& RenderComponent::getScale() const
 	{
-		return mesh->getTransform().getScale();
+		return scale;
 	}
 
 	void RenderComponent::setScale(const vec3& scl)
 	{
-		return mesh->getTransform().scaleMatrix(scl);
+		scale = scl;
 	}
 
 	const vec3& RenderComponent::getPosition() const 
 	{
-		return mesh->getTransform().getTranslation();
+		return position;
 	}
 
 	void RenderComponent::setPosition(const vec3& pos) 
 	{
-		mesh->getTransform().translateMatrix(pos);
+		position = pos;
 	}
 
 	void RenderComponent::setRotation(quat const& rotation) 
 	{
-		mesh->getTransform().rotateMatrix(rotation);
+		this->rotation = rotation;
 	}
 
 	quat const& RenderComponent::getRotation() const 
 	{
-		return mesh->getTransform().getRotation();
+		return rotation;
 	}
 
 	void RenderComponent::onTick(float elapsedTime)
@@ -50,7 +49,14 @@ namespace ginkgo
 
 	void RenderComponent::onTickEnd(float elapsedTime)
 	{
-		setPosition(parent->getPosition());
+		position = parent->getPosition();
+		rotation = parent->getRotation();
+		//the render thread owns the transform, hand it this tick's state instead of writing it
+		IRenderer* renderer = getRendererInstance();
+		if (renderer != nullptr)
+		{
+			renderer->getWriteSnapshot().transforms.emplace_back(TransformState(UID, position, rotation, scale));
+		}
 	}
 
 	IEntity* RenderComponent::getParent() 
@@ -65,8 +71,17 @@ namespace ginkgo
 
 	void RenderComponent::onDetach()
 	{
-		getRendererInstance()->removeRenderable(mesh->getIndex());
-		delete mesh;
+		//the render thread may be drawing it right now, it removes and deletes it between frames
+		IRenderer* renderer = getRendererInstance();
+		if (renderer != nullptr)
+		{
+			renderer->releaseRenderable(mesh);
+		}
+		else
+		{
+			delete mesh;
+		}
+		mesh = nullptr;
 	}
 
 	IRenderComponent::~IRenderComponent() {}
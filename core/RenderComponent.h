@@ -8,9 +8,15 @@ namespace ginkgo
 	class RenderComponent : public IRenderComponent
 	{
 	private:
+		//owned by the render thread, only its UID is read here
 		IRenderable* mesh;
+		int UID;
 
 		IEntity* parent;
+		//simulation side copy, published every tick, the renderable's transform is never touched from here
+		vec3 position;
+		quat rotation;
+		vec3 scale;
 
 	public:
 		RenderComponent(IEntity* parent, IRenderable* mesh);
@@ -4,6 +4,23 @@
 
 namespace ginkgo
 {
+	UserInputSystem::UserInputSystem()
+		: owner(nullptr), bindTable(INCODE_TABLE_SIZE, invalidControl), stateTable(INCODE_TABLE_SIZE, nullptr), inputMapping(nullptr)
+	{
+	}
+
+	UserInputSystem::~UserInputSystem()
+	{
+		for (CommandState* state : controlStates)
+		{
+			delete state;
+		}
+		for (Command* c : commandList)
+		{
+			delete c;
+		}
+	}
+
 	void UserInputSystem::setInputMapping(IInputMapping* inputMapping)
 	{
 		this->inputMapping = inputMapping;
@@ -61,42 +78,38 @@ namespace ginkgo
 	void UserInputSystem::bindInputCode(int in, int out)
 	{
 		Command const& outputCommand = findCommand(out);
-		if (outputCommand.outputCode == -1)
+		if (outputCommand.outputCode == -1 || !inputCodeInRange(in))
 		{
 			return;
 		}
-		bindings.emplace_back(Bind(INPUTTYPE_USER, in, out));
-		controlStates.emplace_back(new CommandState(outputCommand));
+		//rebinding a key replaces its old binding
+		unbindInputCode(in);
+
+		CommandState* state = new CommandState(outputCommand);
+		bindTable[in - INCODE_MOUSE] = Bind(INPUTTYPE_USER, in, out);
+		stateTable[in - INCODE_MOUSE] = state;
+		controlStates.emplace_back(state);
 	}
 
 	void UserInputSystem::unbindInputCode(int inputCode)
 	{
-		int outCode;
-		bool codeFound = false;
-		for (UINT32 a = 0; a < bindings.size(); a++)
-		{
-			if (bindings[a].inputCode == inputCode)
-			{
-				outCode = bindings[a].outputCode;
-				codeFound = true;
-				bindings.erase(bindings.begin() + a);
-				break;
-			}
-		}
-		if (!codeFound)
+		if (!inputCodeInRange(inputCode) || stateTable[inputCode - INCODE_MOUSE] == nullptr)
 		{
 			return;
 		}
+		CommandState* state = stateTable[inputCode - INCODE_MOUSE];
+		bindTable[inputCode - INCODE_MOUSE] = invalidControl;
+		stateTable[inputCode - INCODE_MOUSE] = nullptr;
 
 		for (UINT32 a = 0; a < controlStates.size(); a++)
 		{
-			if (controlStates[a]->command->outputCode == outCode)
+			if (controlStates[a] == state)
 			{
-				delete controlStates[a];
 				controlStates.erase(controlStates.begin() + a);
 				break;
 			}
 		}
+		delete state;
 	}
 
 	void UserInputSystem::setOwner(ICharacter* owner)
@@ -144,28 +157,32 @@ namespace ginkgo
 
 	Command* UserInputSystem::onInputCode(Bind const& input, bool set)
 	{
-		for (CommandState* state : controlStates)
+		return onRawInput(input.inputCode, set, 0);
+	}
+
+	Command* UserInputSystem::onRawInput(int inputCode, bool set, long long timestamp)
+	{
+		if (!inputCodeInRange(inputCode))
 		{
-			if (input.outputCode == state->command->outputCode)
-			{
-				state->isSet = set;
-				return state->command;
-			}
+			return nullptr;
+		}
+		CommandState* state = stateTable[inputCode - INCODE_MOUSE];
+		if (state == nullptr)
+		{
+			return nullptr;
 		}
-		return nullptr;
+		state->isSet = set;
+		state->timestamp = timestamp;
+		return state->command;
 	}
 
 	Bind const& UserInputSystem::getControl(int inputCode)
 	{
-		for (Bind const& c : bindings)
+		if (!inputCodeInRange(inputCode))
 		{
-			if (c.inputCode == inputCode)
-			{
-				return c;
-			}
+			return invalidControl;
 		}
-
-		return invalidControl;
+		return bindTable[inputCode - INCODE_MOUSE];
 	}
 
 
@@ -11,14 +11,21 @@ namespace ginkgo
 		const CommandSetReset invalidCommand = CommandSetReset(-1, nullptr);
 
 		ICharacter* owner;
-		vector<Bind> bindings;
 		vector<Command*> commandList;
 		vector<CommandState*> controlStates;
 
+		//indexed directly by inputCode - INCODE_MOUSE
+		vector<Bind> bindTable;
+		vector<CommandState*> stateTable;
+
 		IInputMapping* inputMapping;
 
 		Command const& findCommand(int outputCode) const;
+		static bool inputCodeInRange(int inputCode) { return inputCode >= INCODE_MOUSE && inputCode < INCODE_MOUSE + INCODE_TABLE_SIZE; }
 	public:
+		UserInputSystem();
+		~UserInputSystem();
+
 		virtual void setInputMapping(IInputMapping* inputMapping) override;
 		virtual IInputMapping* getInputMapping() const override;
 
@@ -34,6 +41,7 @@ namespace ginkgo
 		virtual ICharacter* getOwner() override;
 
 		virtual Command* onInputCode(Bind const& input, bool set) override;
+		virtual Command* onRawInput(int inputCode, bool set, long long timestamp) override;
 		virtual void runInput() override;
 
 		virtual Bind const& getControl(int inputState) override;
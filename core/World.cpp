@@ -1,5 +1,6 @@
 #include "World.h"
 #include "IEntity.h"
+#include "ICharacter.h"
 #include "IRenderable.h"
 #include "IPhysicsObject.h"
 #include "SurfaceCollisionMesh.h"
@@ -18,6 +19,11 @@ namespace ginkgo
 		return entityList;
 	}
 
+	const vector<ICharacter*>& World::getCharacterList() const
+	{
+		return characterList;
+	}
+
 	vector<IEntity*> World::getEntitiesByType(EntityType type) const
 	{
 		vector<IEntity*> newEntityList;
@@ -52,6 +58,8 @@ namespace ginkgo
 			delete entityList.at(a);
 		}
 		entityList.clear();
+		characterList.clear();
+		manager.InvalidateStateBuckets();
 		worldTree.resetTree(0, Prism(WORLD_DIMENSIONS));
 	}
 
@@ -81,6 +89,15 @@ namespace ginkgo
 	void World::addEntity(IEntity* entity)
 	{
 		entityList.push_back(entity);
+
+		//only time we need to find out if this is a character
+		ICharacter* character = dynamic_cast<ICharacter*>(entity);
+		if (character != nullptr)
+		{
+			characterList.push_back(character);
+			manager.InvalidateStateBuckets();
+		}
+
 		if (entity->getEntityType() >= physicsObject)
 		{
 			worldTree.insert(entity->getPhysics());
@@ -113,6 +130,17 @@ namespace ginkgo
 				a--;
 			}
 		}
+		for (UINT32 c = 0; c < characterList.size(); c++)
+		{
+			if (static_cast<IEntity*>(characterList[c]) == e)
+			{
+				//order doesn't matter, swap with the back
+				characterList[c] = characterList.back();
+				characterList.pop_back();
+				manager.InvalidateStateBuckets();
+				break;
+			}
+		}
 		delete entityList.at(a);
 		entityList.erase(entityList.begin() + a);
 	}
@@ -150,12 +178,12 @@ namespace ginkgo
 
 	void World::checkMovementStates(float elapsedTime)
 	{
-		manager.CheckMovementStates(this->entityList, elapsedTime);
+		manager.CheckMovementStates(this->characterList, elapsedTime);
 	}
 
 	void World::doMovementStates(float elapsedTime)
 	{
-		manager.DoCallbacks(this->entityList, elapsedTime);
+		manager.DoCallbacks(this->characterList, elapsedTime);
 	}
 
 	void World::addCollision(CollisionInfo const& info, float deltaTime)
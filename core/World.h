@@ -9,6 +9,7 @@
 namespace ginkgo
 {
 	class IEntity;
+	class ICharacter;
 	class Octree;
 
 	class World : public IWorld
@@ -16,6 +17,8 @@ namespace ginkgo
 	private:
 		vec3 gravity;
 		vector<IEntity*> entityList;
+		//dense list of every character in entityList, kept in sync by addEntity/removeEntity
+		vector<ICharacter*> characterList;
 		Octree worldTree;
 		vector<Collision> collisions;
 		MovementStateCallbackManager manager;
@@ -24,6 +27,7 @@ namespace ginkgo
 		World(float gravity);
 		vector<IEntity*> getEntitiesByType(EntityType type) const override;
 		const vector<IEntity*>& getEntityList() const;
+		const vector<ICharacter*>& getCharacterList() const override;
 
 		void clearWorld() override;
 
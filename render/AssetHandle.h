@@ -0,0 +1,61 @@
+#pragma once
+
+#include "RenderResource.h"
+#include <atomic>
+#include <memory>
+
+namespace ginkgo {
+
+	class Mesh;
+	struct Texture;
+
+	enum AssetStatus
+	{
+		ASSET_PENDING,
+		ASSET_READY,
+		ASSET_FAILED,
+	};
+
+	//shared by a handle and the loader working on it
+	struct AssetState
+	{
+		AssetState()
+			: status(ASSET_PENDING), cancelled(false)
+		{}
+
+		std::atomic<int> status;
+		std::atomic<bool> cancelled;
+	};
+
+	//future like result of an asynchronous load
+	//the asset exists from the start and can be handed to materials and renderables right away,
+	//it draws as a placeholder until its data has been uploaded
+	template<typename T>
+	class AssetHandle
+	{
+	private:
+		T* asset;
+		std::shared_ptr<AssetState> state;
+
+	public:
+		AssetHandle()
+			: asset(nullptr)
+		{}
+
+		AssetHandle(T* asset, const std::shared_ptr<AssetState>& state)
+			: asset(asset), state(state)
+		{}
+
+		T* get() const { return asset; }
+
+		AssetStatus getStatus() const
+		{
+			return (state != nullptr) ? (AssetStatus)state->status.load(std::memory_order_acquire) : ASSET_FAILED;
+		}
+		bool isReady() const { return getStatus() == ASSET_READY; }
+		bool isPending() const { return getStatus() == ASSET_PENDING; }
+	};
+
+	typedef AssetHandle<Mesh> MeshHandle;
+	typedef AssetHandle<Texture> TextureHandle;
+}
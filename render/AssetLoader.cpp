@@ -0,0 +1,254 @@
+#include "AssetLoader.h"
+
+#include "Texture.h"
+#include "FileUtils.h"
+#include "GLState.h"
+#include "ObjLoader.h"
+#include "MeshCache.h"
+#include <chrono>
+#include <cstring>
+#include <iostream>
+#include <stdexcept>
+
+namespace ginkgo {
+
+	AssetLoader::AssetLoader(unsigned int workerCount)
+		: stopping(false)
+	{
+		glGenBuffers(1, &uploadPBO);
+		for (unsigned int i = 0; i < workerCount; i++)
+		{
+			workers.emplace_back(&AssetLoader::work, this);
+		}
+	}
+
+	AssetLoader::~AssetLoader()
+	{
+		{
+			std::lock_guard<std::mutex> lock(queuedMutex);
+			stopping = true;
+		}
+		queuedCondition.notify_all();
+		for (unsigned int i = 0; i < workers.size(); i++)
+		{
+			workers[i].join();
+		}
+		GLState::deleteBuffers(1, &uploadPBO);
+	}
+
+	void AssetLoader::work()
+	{
+		while (true)
+		{
+			std::unique_ptr<Job> job;
+			{
+				std::unique_lock<std::mutex> lock(queuedMutex);
+				queuedCondition.wait(lock, [this] { return stopping || !queued.empty(); });
+				if (stopping)
+				{
+					return;
+				}
+				job = std::move(queued.front());
+				queued.pop_front();
+			}
+
+			if (!job->state->cancelled.load(std::memory_order_acquire))
+			{
+				decode(*job);
+			}
+
+			std::lock_guard<std::mutex> lock(finishedMutex);
+			finished.push_back(std::move(job));
+		}
+	}
+
+	//worker thread, no GL in here
+	void AssetLoader::decode(Job& job)
+	{
+		if (job.type == Job::JOB_TEXTURE)
+		{
+			string cachePath = TextureCache::getCachePath(job.path);
+			if (TextureCache::isSupported() && TextureCache::read(cachePath, job.path, job.cooked))
+			{
+				job.decoded = true;
+				return;
+			}
+			job.pixels = FileUtils::loadImage(job.path.c_str(), &job.width, &job.height);
+			job.decoded = job.pixels != nullptr;
+			if (job.decoded && TextureCache::isSupported())
+			{
+				job.cooked = TextureCache::cook(job.pixels, job.width, job.height);
+				TextureCache::save(cachePath, job.path, job.cooked);
+			}
+			return;
+		}
+
+		string cachePath = MeshCache::getCachePath(job.path, job.format);
+		if (MeshCache::read(cachePath, job.path, job.format, job.mesh))
+		{
+			job.decoded = true;
+			return;
+		}
+		try
+		{
+			ObjLoader meshData(job.path, &job.stats);
+			job.imported = true;
+			vector<GLfloat> vertices = Mesh::interleave(meshData.getPositionList(), meshData.getIndexList(), meshData.getUVList(), meshData.getNormalList());
+			const vector<GLuint>& indices = meshData.getIndexList();
+			GLuint vertexCount = meshData.getPositionList().size();
+			const GLfloat* vertexData = vertices.empty() ? nullptr : &vertices[0];
+			Mesh::pack(job.format, vertexData, vertexCount, indices.empty() ? nullptr : &indices[0], indices.size(), Mesh::computeBounds(vertexData, vertexCount), job.mesh);
+			MeshCache::save(cachePath, job.path, job.mesh);
+			job.decoded = true;
+		}
+		catch (std::runtime_error e)
+		{
+			//left undecoded, reported from the render thread when the job is collected
+		}
+	}
+
+	bool AssetLoader::upload(Job& job)
+	{
+		if (job.type == Job::JOB_MESH)
+		{
+			Mesh* mesh = (Mesh*)job.target;
+			return mesh->addPackedData(job.mesh);
+		}
+
+		Texture* t = (Texture*)job.target;
+		if (!job.cooked.levels.empty())
+		{
+			TextureCache::upload(job.cooked, t->tid, job.pixelate, uploadPBO);
+			t->width = job.cooked.levels[0].width;
+			t->height = job.cooked.levels[0].height;
+			return true;
+		}
+
+		//through a pixel buffer so glTexImage3D can return before the driver has copied the pixels
+		GLsizeiptr size = job.width * job.height * 3;
+		GLState::bindBuffer(GL_PIXEL_UNPACK_BUFFER, uploadPBO);
+		//orphans the previous upload's storage instead of waiting on it
+		glBufferData(GL_PIXEL_UNPACK_BUFFER, size, NULL, GL_STREAM_DRAW);
+		void* destination = glMapBufferRange(GL_PIXEL_UNPACK_BUFFER, 0, size, GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_BUFFER_BIT);
+		if (destination != nullptr)
+		{
+			memcpy(destination, job.pixels, size);
+			glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER);
+		}
+		else
+		{
+			//straight from job.pixels, which GL would take as an offset into a bound unpack buffer
+			GLState::bindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+		}
+
+		GLint alignment;
+		glGetIntegerv(GL_UNPACK_ALIGNMENT, &alignment);
+		glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+		GLState::bindTexture(GL_TEXTURE_2D_ARRAY, t->tid);
+		glTexImage3D(GL_TEXTURE_2D_ARRAY, 0, GL_RGB, job.width, job.height, 1, 0, GL_BGR, GL_UNSIGNED_BYTE, destination != nullptr ? 0 : job.pixels);
+		glGenerateMipmap(GL_TEXTURE_2D_ARRAY);
+		glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MIN_FILTER, (job.pixelate) ? GL_NEAREST_MIPMAP_NEAREST : GL_LINEAR_MIPMAP_LINEAR);
+		GLState::bindTexture(GL_TEXTURE_2D_ARRAY, 0);
+		glPixelStorei(GL_UNPACK_ALIGNMENT, alignment);
+		GLState::bindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+
+		t->width = job.width;
+		t->height = job.height;
+		return true;
+	}
+
+	void AssetLoader::enqueue(std::unique_ptr<Job> job)
+	{
+		inFlight[job->target] = job->state;
+		{
+			std::lock_guard<std::mutex> lock(queuedMutex);
+			queued.push_back(std::move(job));
+		}
+		queuedCondition.notify_one();
+	}
+
+	TextureHandle AssetLoader::loadTexture(const string& path, bool pixelate)
+	{
+		Texture* t = new Texture();
+		t->filepath = path;
+		t->width = 1;
+		t->height = 1;
+		GLState::bindTexture(GL_TEXTURE_2D_ARRAY, t->tid);
+		GLenum option = (pixelate) ? GL_NEAREST : GL_LINEAR;
+		glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MIN_FILTER, option);
+		glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAG_FILTER, option);
+		static const unsigned char white[4] = { 255, 255, 255, 255 };
+		glTexImage3D(GL_TEXTURE_2D_ARRAY, 0, GL_RGB, 1, 1, 1, 0, GL_BGR, GL_UNSIGNED_BYTE, white);
+		GLState::bindTexture(GL_TEXTURE_2D_ARRAY, 0);
+
+		std::shared_ptr<AssetState> state = std::make_shared<AssetState>();
+		std::unique_ptr<Job> job(new Job(Job::JOB_TEXTURE, path, t, state));
+		job->pixelate = pixelate;
+		enqueue(std::move(job));
+		return TextureHandle(t, state);
+	}
+
+	MeshHandle AssetLoader::loadMesh(const string& path, VertexFormat format)
+	{
+		//an empty mesh draws nothing until the real data is in
+		Mesh* mesh = new Mesh(format);
+
+		std::shared_ptr<AssetState> state = std::make_shared<AssetState>();
+		std::unique_ptr<Job> job(new Job(Job::JOB_MESH, path, mesh, state));
+		job->format = format;
+		enqueue(std::move(job));
+		return MeshHandle(mesh, state);
+	}
+
+	void AssetLoader::update(double budgetMilliseconds)
+	{
+		auto start = std::chrono::steady_clock::now();
+		while (true)
+		{
+			std::unique_ptr<Job> job;
+			{
+				std::lock_guard<std::mutex> lock(finishedMutex);
+				if (finished.empty())
+				{
+					return;
+				}
+				job = std::move(finished.front());
+				finished.pop_front();
+			}
+
+			if (!job->state->cancelled.load(std::memory_order_acquire))
+			{
+				inFlight.erase(job->target);
+				//logged here rather than on the worker so lines from several imports don't interleave
+				if (job->decoded && job->imported)
+				{
+					ObjLoader::logStats(job->path, job->stats);
+				}
+				bool loaded = job->decoded && upload(*job);
+				if (!loaded)
+				{
+					std::cout << "Failed to load " << job->path << ", keeping the placeholder!" << std::endl;
+				}
+				job->state->status.store(loaded ? ASSET_READY : ASSET_FAILED, std::memory_order_release);
+			}
+
+			if (std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count() >= budgetMilliseconds)
+			{
+				return;
+			}
+		}
+	}
+
+	void AssetLoader::cancel(const void* asset)
+	{
+		auto it = inFlight.find(asset);
+		if (it == inFlight.end())
+		{
+			return;
+		}
+		it->second->cancelled.store(true, std::memory_order_release);
+		it->second->status.store(ASSET_FAILED, std::memory_order_release);
+		inFlight.erase(it);
+	}
+
+}
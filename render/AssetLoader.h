@@ -0,0 +1,87 @@
+#pragma once
+
+#include "AssetHandle.h"
+#include "Mesh.h"
+#include "TextureCache.h"
+#include "ObjLoader.h"
+#include <GL/glew.h>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <deque>
+#include <unordered_map>
+
+namespace ginkgo {
+
+	//decodes images and parses meshes on a pool of worker threads,
+	//the render thread then uploads whatever finished through update, a few milliseconds a frame
+	class AssetLoader
+	{
+	private:
+		struct Job
+		{
+			enum Type { JOB_TEXTURE, JOB_MESH };
+
+			Job(Type type, const string& path, void* target, const std::shared_ptr<AssetState>& state)
+				: type(type), path(path), target(target), state(state), decoded(false), pixelate(false), pixels(nullptr), width(0), height(0), format(VERTEX_FLOAT), imported(false)
+			{}
+			~Job() { delete[] pixels; }
+
+			Type type;
+			string path;
+			void* target; //Texture* or Mesh*, only touched on the render thread
+			std::shared_ptr<AssetState> state;
+			bool decoded;
+
+			//JOB_TEXTURE, cooked when the driver takes S3TC, otherwise 24 bit BGR
+			bool pixelate;
+			CookedTexture cooked;
+			unsigned char* pixels;
+			GLsizei width;
+			GLsizei height;
+
+			//JOB_MESH, already in the target mesh's GPU layout
+			VertexFormat format;
+			PackedMesh mesh;
+			bool imported; //parsed from the obj instead of the cache, stats is filled
+			ObjLoadStats stats;
+		};
+
+		vector<std::thread> workers;
+		bool stopping;
+
+		std::mutex queuedMutex;
+		std::condition_variable queuedCondition;
+		std::deque<std::unique_ptr<Job>> queued;
+
+		std::mutex finishedMutex;
+		std::deque<std::unique_ptr<Job>> finished;
+
+		//render thread only
+		std::unordered_map<const void*, std::shared_ptr<AssetState>> inFlight;
+		GLuint uploadPBO;
+
+		void work();
+		static void decode(Job& job);
+		//false if the decoded data couldn't be used
+		bool upload(Job& job);
+		void enqueue(std::unique_ptr<Job> job);
+
+	public:
+		AssetLoader(unsigned int workerCount);
+		//waits for the workers to finish their current job
+		~AssetLoader();
+
+		//render thread: returns straight away with a white 1x1 texture / an empty mesh that fill in later
+		TextureHandle loadTexture(const string& path, bool pixelate);
+		MeshHandle loadMesh(const string& path, VertexFormat format);
+
+		//render thread: uploads finished loads until budgetMilliseconds are used, at least one per call
+		void update(double budgetMilliseconds);
+		//render thread: the asset is about to be deleted, drop its load
+		void cancel(const void* asset);
+
+		unsigned int getInFlightCount() const { return inFlight.size(); }
+	};
+
+}
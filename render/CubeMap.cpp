@@ -4,6 +4,8 @@
 
 #include "FileUtils.h"
 #include "Transform.h"
+#include "GLState.h"
+#include <future>
 
 namespace ginkgo {
 
@@ -14,50 +16,45 @@ namespace ginkgo {
 		compileShader();
 
 		glGenTextures(1, &textureID);
-		glActiveTexture(GL_TEXTURE0);
+		GLState::activeTexture(GL_TEXTURE0);
 
-		int width, height;
-		unsigned char* image;
-
-		glBindTexture(GL_TEXTURE_CUBE_MAP, textureID);
-
-		//RIGHT FACE
-		image = FileUtils::loadImage(faces[CM_RIGHT].c_str(), &width, &height, 180.0f);
-		glTexImage2D(GL_TEXTURE_CUBE_MAP_POSITIVE_X + CM_LEFT, 0, GL_RGB, width, height, 0, GL_BGR, GL_UNSIGNED_BYTE, image);
-		delete[] image;
-
-		//LEFT FACE
-		image = FileUtils::loadImage(faces[CM_LEFT].c_str(), &width, &height, 180.0f);
-		glTexImage2D(GL_TEXTURE_CUBE_MAP_POSITIVE_X + CM_RIGHT, 0, GL_RGB, width, height, 0, GL_BGR, GL_UNSIGNED_BYTE, image);
-		delete[] image;
-
-		//TOP FACE
-		image = FileUtils::loadImage(faces[CM_TOP].c_str(), &width, &height, 180.0f);
-		glTexImage2D(GL_TEXTURE_CUBE_MAP_POSITIVE_X + CM_TOP, 0, GL_RGB, width, height, 0, GL_BGR, GL_UNSIGNED_BYTE, image);
-		delete[] image;
-
-		//BOTTOM FACE
-		image = FileUtils::loadImage(faces[CM_BOTTOM].c_str(), &width, &height, 180.0f);
-		glTexImage2D(GL_TEXTURE_CUBE_MAP_POSITIVE_X + CM_BOTTOM, 0, GL_RGB, width, height, 0, GL_BGR, GL_UNSIGNED_BYTE, image);
-		delete[] image;
-
-		//FRONT FACE
-		image = FileUtils::loadImage(faces[CM_FRONT].c_str(), &width, &height, 180.0f);
-		glTexImage2D(GL_TEXTURE_CUBE_MAP_POSITIVE_X + CM_BACK, 0, GL_RGB, width, height, 0, GL_BGR, GL_UNSIGNED_BYTE, image);
-		delete[] image;
-
-		//BACK FACE
-		image = FileUtils::loadImage(faces[CM_BACK].c_str(), &width, &height, 180.0f);
-		glTexImage2D(GL_TEXTURE_CUBE_MAP_POSITIVE_X + CM_FRONT, 0, GL_RGB, width, height, 0, GL_BGR, GL_UNSIGNED_BYTE, image);
-		delete[] image;
+		GLState::bindTexture(GL_TEXTURE_CUBE_MAP, textureID);
 
+		//decode all six faces at once, then upload in order
+		//images are rotated 180 degrees, so left/right and front/back land on the opposite face
+		static const unsigned int faceTargets[6][2] = {
+			{ CM_RIGHT, CM_LEFT }, { CM_LEFT, CM_RIGHT }, { CM_TOP, CM_TOP },
+			{ CM_BOTTOM, CM_BOTTOM }, { CM_FRONT, CM_BACK }, { CM_BACK, CM_FRONT }
+		};
+		struct FaceImage
+		{
+			unsigned char* pixels;
+			int width, height;
+		};
+		std::future<FaceImage> decoded[6];
+		for (int f = 0; f < 6; f++)
+		{
+			string path = faces[faceTargets[f][0]];
+			decoded[f] = std::async(std::launch::async, [path]()
+			{
+				FaceImage image;
+				image.pixels = FileUtils::loadImage(path.c_str(), &image.width, &image.height, 180.0f);
+				return image;
+			});
+		}
+		for (int f = 0; f < 6; f++)
+		{
+			FaceImage image = decoded[f].get();
+			glTexImage2D(GL_TEXTURE_CUBE_MAP_POSITIVE_X + faceTargets[f][1], 0, GL_RGB, image.width, image.height, 0, GL_BGR, GL_UNSIGNED_BYTE, image.pixels);
+			delete[] image.pixels;
+		}
 
 		glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
 		glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
 		glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
 		glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
 		glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_R, GL_CLAMP_TO_EDGE);
-		glBindTexture(GL_TEXTURE_CUBE_MAP, 0);
+		GLState::bindTexture(GL_TEXTURE_CUBE_MAP, 0);
 
 		GLfloat vertices[] = { -1.0f, 1.0f, -1.0f, -1.0f, -1.0f, -1.0f, 1.0f, -1.0f, -1.0f, 1.0f, -1.0f, -1.0f, 1.0f, 1.0f, -1.0f, -1.0f, 1.0f, -1.0f, -1.0f, -1.0f, 1.0f, -1.0f, -1.0f, -1.0f, -1.0f, 1.0f, -1.0f, -1.0f, 1.0f, -1.0f, -1.0f, 1.0f, 1.0f, -1.0f, -1.0f, 1.0f, 1.0f, -1.0f, -1.0f, 1.0f, -1.0f, 1.0f, 1.0f, 1.0f, 1.0f, 1.0f, 1.0f, 1.0f, 1.0f, 1.0f, -1.0f, 1.0f, -1.0f, -1.0f, -1.0f, -1.0f, 1.0f, -1.0f, 1.0f, 1.0f, 1.0f, 1.0f, 1.0f, 1.0f, 1.0f, 1.0f, 1.0f, -1.0f, 1.0f, -1.0f, -1.0f, 1.0f, -1.0f, 1.0f, -1.0f, 1.0f, 1.0f, -1.0f, 1.0f, 1.0f, 1.0f, 1.0f, 1.0f, 1.0f, -1.0f, 1.0f, 1.0f, -1.0f, 1.0f, -1.0f, -1.0f, -1.0f, -1.0f, -1.0f, -1.0f, 1.0f, 1.0f, -1.0f, -1.0f, 1.0f, -1.0f, -1.0f, -1.0f, -1.0f, 1.0f, 1.0f, -1.0f, 1.0f };
 
@@ -68,48 +65,38 @@ namespace ginkgo {
 
 		glGenVertexArrays(1, &VAO);
 		glGenBuffers(1, &VBO);
-		glBindVertexArray(VAO);
-		glBindBuffer(GL_ARRAY_BUFFER, VBO);
+		GLState::bindVertexArray(VAO);
+		GLState::bindBuffer(GL_ARRAY_BUFFER, VBO);
 		glBufferData(GL_ARRAY_BUFFER, sizeof(vertices), &vertices, GL_STATIC_DRAW);
 		glEnableVertexAttribArray(0);
 		glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 3 * sizeof(GLfloat), (GLvoid*)0);
-		glBindBuffer(GL_ARRAY_BUFFER, 0);
-		glBindVertexArray(0);
+		GLState::bindBuffer(GL_ARRAY_BUFFER, 0);
+		GLState::bindVertexArray(0);
 	}
 
 	CubeMap::~CubeMap() {
-		glDeleteTextures(1, &textureID);
-		glDeleteBuffers(1, &VBO);
-		glDeleteVertexArrays(1, &VAO);
+		GLState::deleteTextures(1, &textureID);
+		GLState::deleteBuffers(1, &VBO);
+		GLState::deleteVertexArrays(1, &VAO);
 	}
 
-	void CubeMap::bindCubeMapTexture() const
+	void CubeMap::bindCubeMapTexture(unsigned int unit) const
 	{
-		glBindTexture(GL_TEXTURE_CUBE_MAP, textureID);
-	}
-
-	void CubeMap::unbindCubeMapTexture() const
-	{
-		glBindTexture(GL_TEXTURE_CUBE_MAP, 0);
+		GLState::bindTexture(unit, GL_TEXTURE_CUBE_MAP, textureID);
 	}
 
 	void CubeMap::draw(const mat4& transformProjectionView) const
 	{
 		bind();
 
-		glDepthFunc(GL_LEQUAL);
+		GLState::depthFunc(GL_LEQUAL);
 
-		glBindVertexArray(VAO);
-		glActiveTexture(GL_TEXTURE0);
-		glBindTexture(GL_TEXTURE_CUBE_MAP, textureID);
+		GLState::bindVertexArray(VAO);
+		GLState::bindTexture(0, GL_TEXTURE_CUBE_MAP, textureID);
 		setUniformMat4("transform", transformProjectionView);
 		glDrawArrays(GL_TRIANGLES, 0, 36);
-		glBindTexture(GL_TEXTURE_CUBE_MAP, 0);
-		glBindVertexArray(0);
 		
-		glDepthFunc(GL_LESS);
-
-		unbind();
+		GLState::depthFunc(GL_LESS);
 	}
 
 	ICubeMap* cubeMapFactory(map<unsigned int, string>& faces, float scale)
@@ -20,8 +20,7 @@ namespace ginkgo {
 		CubeMap(map<unsigned int, string> faces, float scale);
 		~CubeMap();
 		void draw(const mat4& transformProjectionView) const override;
-		void bindCubeMapTexture() const override;
-		void unbindCubeMapTexture() const override;
+		void bindCubeMapTexture(unsigned int unit) const override;
 	};
 	
 }
\ No newline at end of file
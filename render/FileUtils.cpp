@@ -75,14 +75,31 @@ namespace ginkgo {
 
 		glReadPixels(0, 0, width, height, GL_BGR, GL_UNSIGNED_BYTE, pixels);
 
-		FIBITMAP* image = FreeImage_ConvertFromRawBits(pixels, width, height, 3 * width, 24, 0x0000FF, 0xFF0000, 0x00FF00, false);
-		FreeImage_Save(FIF_BMP, image, ("Render" + std::to_string(id) + ".bmp").c_str(), 0);
+		saveImage(("Render" + std::to_string(id) + ".bmp").c_str(), pixels, width, height);
 		//FreeImage_Save(FIF_BMP, image, "Render.bmp", 0);
 		
-		FreeImage_Unload(image);
 		delete[] pixels;
 
 		id++;
 	}
 
+	bool FileUtils::saveImage(const char* filename, const unsigned char* pixels, unsigned int width, unsigned int height)
+	{
+		FREE_IMAGE_FORMAT format = FreeImage_GetFIFFromFilename(filename);
+		if (format == FIF_UNKNOWN)
+		{
+			std::cout << "No image format for " << filename << std::endl;
+			return false;
+		}
+
+		FIBITMAP* image = FreeImage_ConvertFromRawBits(const_cast<BYTE*>(pixels), width, height, 3 * width, 24, 0x0000FF, 0xFF0000, 0x00FF00, false);
+		bool saved = FreeImage_Save(format, image, filename, 0) == TRUE;
+		FreeImage_Unload(image);
+		if (!saved)
+		{
+			std::cout << "Failed to save " << filename << std::endl;
+		}
+		return saved;
+	}
+
 }
\ No newline at end of file
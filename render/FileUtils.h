@@ -12,7 +12,10 @@ namespace ginkgo {
 	public:
 		static string read_file(const char* filepath);
 		static unsigned char* loadImage(const char* filename, GLsizei* width, GLsizei* height, double rotationAngleInDegrees = 0);
+		//reads back synchronously and encodes on the calling thread, IRenderer::screenshot does neither
 		static void screenshot(unsigned int width, unsigned int height);
+		//pixels are BGR, bottom row first, the format comes from the extension
+		static bool saveImage(const char* filename, const unsigned char* pixels, unsigned int width, unsigned int height);
 	};
 
 }
\ No newline at end of file
@@ -0,0 +1,298 @@
+#define _CRT_SECURE_NO_WARNINGS
+
+#include "FrameCapture.h"
+
+#include "FileUtils.h"
+#include "GLState.h"
+#include <cstring>
+#include <iostream>
+
+namespace ginkgo {
+
+	FrameCapture::FrameCapture()
+		: bufferCount(0), frame(0), stopping(false), encoding(0), sequenceFile(nullptr), sequenceWidth(0), sequenceHeight(0), sequenceFailed(false)
+	{
+		encoder = std::thread(&FrameCapture::encode, this);
+	}
+
+	FrameCapture::~FrameCapture()
+	{
+		stopSequence();
+		finish();
+		{
+			std::lock_guard<std::mutex> lock(queuedMutex);
+			stopping = true;
+		}
+		queuedCondition.notify_all();
+		encoder.join();
+
+		for (unsigned int i = 0; i < freeBuffers.size(); i++)
+		{
+			GLState::deleteBuffers(1, &freeBuffers[i].name);
+		}
+		if (sequenceFile)
+		{
+			fclose(sequenceFile);
+		}
+	}
+
+	void FrameCapture::screenshot(const string& path)
+	{
+		screenshots.push_back(path);
+	}
+
+	void FrameCapture::startSequence(const string& path)
+	{
+		stopSequence();
+		sequencePath = path;
+	}
+
+	void FrameCapture::stopSequence()
+	{
+		if (sequencePath.empty())
+		{
+			return;
+		}
+		//frames of the sequence still being read back go out before the file is closed
+		Readback end = {};
+		end.frame = frame;
+		end.sequencePath = sequencePath;
+		pending.push_back(end);
+		sequencePath.clear();
+	}
+
+	void FrameCapture::update(unsigned int width, unsigned int height)
+	{
+		frame++;
+		while (!pending.empty() && collect(frame - pending.front().frame >= MAX_LATENCY))
+		{
+		}
+
+		if (sequencePath.empty() && screenshots.empty())
+		{
+			return;
+		}
+		string screenshotPath;
+		if (!screenshots.empty())
+		{
+			screenshotPath = screenshots.front();
+			screenshots.pop_front();
+		}
+		readback(width, height, screenshotPath);
+	}
+
+	void FrameCapture::finish()
+	{
+		while (!pending.empty())
+		{
+			collect(true);
+		}
+		std::unique_lock<std::mutex> lock(queuedMutex);
+		drainedCondition.wait(lock, [this] { return queued.empty() && encoding == 0; });
+	}
+
+	void FrameCapture::readback(unsigned int width, unsigned int height, const string& screenshotPath)
+	{
+		if (freeBuffers.empty() && bufferCount < READBACK_BUFFERS)
+		{
+			PackBuffer buffer = { 0, 0 };
+			glGenBuffers(1, &buffer.name);
+			freeBuffers.push_back(buffer);
+			bufferCount++;
+		}
+		//all in flight, the oldest is at least a frame old and about done
+		while (freeBuffers.empty())
+		{
+			collect(true);
+		}
+
+		Readback r = {};
+		r.buffer = freeBuffers.back();
+		freeBuffers.pop_back();
+		r.frame = frame;
+		r.width = width;
+		r.height = height;
+		r.sequencePath = sequencePath;
+		r.screenshotPath = screenshotPath;
+
+		GLsizeiptr size = 3 * width * height;
+		GLState::bindBuffer(GL_PIXEL_PACK_BUFFER, r.buffer.name);
+		if (r.buffer.size != size)
+		{
+			glBufferData(GL_PIXEL_PACK_BUFFER, size, NULL, GL_STREAM_READ);
+			r.buffer.size = size;
+		}
+		glPixelStorei(GL_PACK_ALIGNMENT, 1);
+		//into the bound pack buffer, so this only queues the copy
+		glReadPixels(0, 0, width, height, GL_BGR, GL_UNSIGNED_BYTE, 0);
+		GLState::bindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+		r.fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+
+		pending.push_back(r);
+	}
+
+	bool FrameCapture::collect(bool wait)
+	{
+		Readback& r = pending.front();
+		Job job;
+		job.width = r.width;
+		job.height = r.height;
+
+		if (r.buffer.name != 0)
+		{
+			GLenum status = glClientWaitSync(r.fence, 0, 0);
+			if (status == GL_TIMEOUT_EXPIRED)
+			{
+				if (!wait)
+				{
+					return false;
+				}
+				while (status == GL_TIMEOUT_EXPIRED)
+				{
+					status = glClientWaitSync(r.fence, GL_SYNC_FLUSH_COMMANDS_BIT, 1000000000);
+				}
+			}
+			glDeleteSync(r.fence);
+
+			GLState::bindBuffer(GL_PIXEL_PACK_BUFFER, r.buffer.name);
+			const void* source = glMapBufferRange(GL_PIXEL_PACK_BUFFER, 0, r.buffer.size, GL_MAP_READ_BIT);
+			if (source != nullptr)
+			{
+				takeSpare(job.pixels, r.buffer.size);
+				memcpy(job.pixels.data(), source, r.buffer.size);
+				glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
+			}
+			else
+			{
+				std::cout << "Failed to map a frame capture!" << std::endl;
+			}
+			GLState::bindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+			freeBuffers.push_back(r.buffer);
+
+			if (source != nullptr)
+			{
+				if (!r.screenshotPath.empty())
+				{
+					Job image = job;
+					image.type = Job::JOB_IMAGE;
+					image.path = r.screenshotPath;
+					enqueue(image);
+				}
+				if (!r.sequencePath.empty())
+				{
+					job.type = Job::JOB_SEQUENCE_FRAME;
+					job.path = r.sequencePath;
+					enqueue(job);
+				}
+			}
+		}
+		else
+		{
+			job.type = Job::JOB_SEQUENCE_END;
+			job.path = r.sequencePath;
+			enqueue(job);
+		}
+
+		pending.pop_front();
+		return true;
+	}
+
+	void FrameCapture::enqueue(Job& job)
+	{
+		{
+			std::unique_lock<std::mutex> lock(queuedMutex);
+			drainedCondition.wait(lock, [this] { return queued.size() < MAX_QUEUED_FRAMES; });
+			queued.push_back(std::move(job));
+		}
+		queuedCondition.notify_one();
+	}
+
+	void FrameCapture::takeSpare(vector<unsigned char>& pixels, size_t size)
+	{
+		{
+			std::lock_guard<std::mutex> lock(queuedMutex);
+			if (!spare.empty())
+			{
+				pixels.swap(spare.back());
+				spare.pop_back();
+			}
+		}
+		pixels.resize(size);
+	}
+
+	void FrameCapture::encode()
+	{
+		while (true)
+		{
+			Job job;
+			{
+				std::unique_lock<std::mutex> lock(queuedMutex);
+				queuedCondition.wait(lock, [this] { return stopping || !queued.empty(); });
+				if (queued.empty())
+				{
+					return;
+				}
+				job = std::move(queued.front());
+				queued.pop_front();
+				encoding++;
+			}
+
+			write(job);
+
+			{
+				std::lock_guard<std::mutex> lock(queuedMutex);
+				encoding--;
+				if (spare.size() < MAX_QUEUED_FRAMES && !job.pixels.empty())
+				{
+					spare.push_back(std::move(job.pixels));
+				}
+			}
+			drainedCondition.notify_all();
+		}
+	}
+
+	//encoder thread, no GL in here
+	void FrameCapture::write(Job& job)
+	{
+		if (job.type == Job::JOB_IMAGE)
+		{
+			FileUtils::saveImage(job.path.c_str(), job.pixels.data(), job.width, job.height);
+			return;
+		}
+
+		if (job.type == Job::JOB_SEQUENCE_END)
+		{
+			if (sequenceFile)
+			{
+				fclose(sequenceFile);
+				sequenceFile = nullptr;
+			}
+			sequenceFailed = false;
+			return;
+		}
+
+		if (sequenceFailed)
+		{
+			return;
+		}
+		if (!sequenceFile)
+		{
+			sequenceFile = fopen(job.path.c_str(), "wb");
+			if (!sequenceFile)
+			{
+				std::cout << "Failed to open " << job.path << " for capture!" << std::endl;
+				sequenceFailed = true;
+				return;
+			}
+			sequenceWidth = job.width;
+			sequenceHeight = job.height;
+		}
+		//raw video has one frame size, frames after a resize are left out
+		if (job.width != sequenceWidth || job.height != sequenceHeight)
+		{
+			return;
+		}
+		fwrite(job.pixels.data(), 1, job.pixels.size(), sequenceFile);
+	}
+
+}
@@ -0,0 +1,106 @@
+#pragma once
+
+#include "RenderResource.h"
+#include <GL/glew.h>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <deque>
+#include <cstdio>
+
+namespace ginkgo {
+
+	//reads finished frames back without stalling the render thread
+	//glReadPixels goes into a ring of pixel pack buffers behind a fence, and each buffer is mapped once its fence has passed, a frame or two later
+	//saving images and writing sequences happens on one encoder thread, in the order the frames were rendered
+	class FrameCapture
+	{
+	public:
+		static const unsigned int READBACK_BUFFERS = 3;
+		//a readback still unfinished after this many frames is waited on
+		static const unsigned int MAX_LATENCY = 2;
+		//frames waiting for the encoder, past this the render thread waits rather than dropping or piling up frames
+		static const unsigned int MAX_QUEUED_FRAMES = 8;
+	private:
+		struct Job
+		{
+			enum Type { JOB_IMAGE, JOB_SEQUENCE_FRAME, JOB_SEQUENCE_END };
+
+			Type type;
+			string path;
+			unsigned int width;
+			unsigned int height;
+			vector<unsigned char> pixels; //BGR, bottom row first
+		};
+
+		struct PackBuffer
+		{
+			GLuint name;
+			GLsizeiptr size;
+		};
+
+		struct Readback
+		{
+			PackBuffer buffer; //name 0 for a sequence end, which only keeps its place in line
+			GLsync fence;
+			unsigned int frame;
+			unsigned int width;
+			unsigned int height;
+			string sequencePath;
+			string screenshotPath;
+		};
+
+		//render thread only
+		vector<PackBuffer> freeBuffers;
+		unsigned int bufferCount;
+		std::deque<Readback> pending; //oldest first
+		unsigned int frame;
+		string sequencePath; //empty when not capturing a sequence
+		std::deque<string> screenshots; //one per frame, oldest first
+
+		//encoder
+		std::thread encoder;
+		bool stopping;
+		std::mutex queuedMutex;
+		std::condition_variable queuedCondition; //new job, or stopping
+		std::condition_variable drainedCondition; //a job finished
+		std::deque<Job> queued;
+		unsigned int encoding; //jobs taken off queued but not written yet
+		vector<vector<unsigned char>> spare; //pixel storage the encoder is done with
+
+		//encoder thread only
+		FILE* sequenceFile;
+		unsigned int sequenceWidth, sequenceHeight;
+		bool sequenceFailed; //couldn't be opened, the rest of its frames are dropped without retrying
+
+		FrameCapture(const FrameCapture&) = delete;
+		FrameCapture& operator=(const FrameCapture&) = delete;
+
+		void readback(unsigned int width, unsigned int height, const string& screenshotPath);
+		//maps and hands the oldest readback to the encoder, waiting on its fence if wait is set
+		bool collect(bool wait);
+		void enqueue(Job& job);
+		void takeSpare(vector<unsigned char>& pixels, size_t size);
+		void encode();
+		void write(Job& job);
+	public:
+		FrameCapture();
+		//writes out everything already requested first
+		~FrameCapture();
+
+		//saves a coming frame, the format comes from the extension
+		void screenshot(const string& path);
+		//appends every captured frame to path as raw bgr24, bottom row first, until stopSequence
+		//e.g. ffmpeg -f rawvideo -pix_fmt bgr24 -s WxH -r 60 -i path -vf vflip out.mp4
+		void startSequence(const string& path);
+		void stopSequence();
+		bool isCapturing() const { return !sequencePath.empty(); }
+
+		//render thread, once a frame with the finished image in the bound read framebuffer, before the swap
+		//starts a readback if anything wants this frame and passes finished ones to the encoder
+		void update(unsigned int width, unsigned int height);
+		//blocks until every frame captured so far is written
+		void finish();
+	};
+
+}
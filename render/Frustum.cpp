@@ -0,0 +1,55 @@
+#include <emmintrin.h>
+
+#include "Frustum.h"
+
+namespace ginkgo {
+
+	Frustum::Frustum(const mat4& m)
+	{
+		//glm is column major, m[c][r]
+		vec4 row0(m[0][0], m[1][0], m[2][0], m[3][0]);
+		vec4 row1(m[0][1], m[1][1], m[2][1], m[3][1]);
+		vec4 row2(m[0][2], m[1][2], m[2][2], m[3][2]);
+		vec4 row3(m[0][3], m[1][3], m[2][3], m[3][3]);
+
+		planes[0] = row3 + row0; //left
+		planes[1] = row3 - row0; //right
+		planes[2] = row3 + row1; //bottom
+		planes[3] = row3 - row1; //top
+		planes[4] = row3 + row2; //near
+		planes[5] = row3 - row2; //far
+
+		for (int i = 0; i < 6; i++)
+		{
+			planes[i] /= glm::length(vec3(planes[i]));
+		}
+	}
+
+	void Frustum::cullSpheres(const float* x, const float* y, const float* z, const float* radius, unsigned int count, unsigned char* visible) const
+	{
+		for (unsigned int i = 0; i < count; i += 4)
+		{
+			__m128 px = _mm_loadu_ps(x + i);
+			__m128 py = _mm_loadu_ps(y + i);
+			__m128 pz = _mm_loadu_ps(z + i);
+			__m128 negRadius = _mm_sub_ps(_mm_setzero_ps(), _mm_loadu_ps(radius + i));
+
+			//lanes stay set while the sphere is in front of (or straddling) every plane so far
+			__m128 inside = _mm_castsi128_ps(_mm_set1_epi32(-1));
+			for (int p = 0; p < 6; p++)
+			{
+				__m128 dist = _mm_add_ps(
+					_mm_add_ps(_mm_mul_ps(px, _mm_set1_ps(planes[p].x)), _mm_mul_ps(py, _mm_set1_ps(planes[p].y))),
+					_mm_add_ps(_mm_mul_ps(pz, _mm_set1_ps(planes[p].z)), _mm_set1_ps(planes[p].w)));
+				inside = _mm_and_ps(inside, _mm_cmpge_ps(dist, negRadius));
+			}
+
+			int mask = _mm_movemask_ps(inside);
+			for (unsigned int lane = 0; lane < 4 && i + lane < count; lane++)
+			{
+				visible[i + lane] = (mask >> lane) & 1;
+			}
+		}
+	}
+
+}
@@ -0,0 +1,24 @@
+#pragma once
+
+#include "RenderResource.h"
+
+namespace ginkgo {
+
+	//six planes pulled out of a projection * view (* model) matrix
+	//plane.xyz is the inward facing normal, plane.w the distance
+	class Frustum
+	{
+	private:
+		vec4 planes[6];
+	public:
+		Frustum(const mat4& transformProjectionView);
+
+		const vec4& getPlane(int index) const { return planes[index]; }
+
+		//tests count spheres (structure of arrays) against every plane, 4 at a time
+		//visible[i] is set to 1 if sphere i is at least partially inside, 0 otherwise
+		//arrays must hold a multiple of 4 floats (pad the tail with anything)
+		void cullSpheres(const float* x, const float* y, const float* z, const float* radius, unsigned int count, unsigned char* visible) const;
+	};
+
+}
@@ -0,0 +1,341 @@
+#include "GLState.h"
+
+namespace ginkgo {
+
+	namespace
+	{
+		//never a name gl hands out in practice, stands for "whatever gl has"
+		const GLuint UNKNOWN = 0xFFFFFFFF;
+
+		enum BufferSlot { BUFFER_ARRAY, BUFFER_ELEMENT_ARRAY, BUFFER_UNIFORM, BUFFER_TEXTURE, BUFFER_PIXEL_PACK, BUFFER_PIXEL_UNPACK, BUFFER_COPY_READ, BUFFER_COPY_WRITE, BUFFER_SLOT_COUNT };
+		enum TextureSlot { TEXTURE_2D, TEXTURE_2D_ARRAY, TEXTURE_CUBE_MAP, TEXTURE_BUFFER, TEXTURE_SLOT_COUNT };
+		enum CapabilitySlot { CAP_BLEND, CAP_DEPTH_TEST, CAP_STENCIL_TEST, CAP_CULL_FACE, CAP_DEPTH_CLAMP, CAP_SLOT_COUNT };
+
+		struct State
+		{
+			GLuint program;
+			GLuint vertexArray;
+			GLuint framebuffer;
+			GLuint buffers[BUFFER_SLOT_COUNT];
+			GLuint activeUnit;
+			GLuint textures[GLState::MAX_TEXTURE_UNITS][TEXTURE_SLOT_COUNT];
+			GLuint capabilities[CAP_SLOT_COUNT];
+			GLuint depthFunc;
+			GLuint depthMask;
+			GLuint blendSource, blendDestination;
+
+			unsigned int issued;
+			unsigned int elided;
+
+			State() : issued(0), elided(0) { forget(); }
+
+			void forget()
+			{
+				program = vertexArray = framebuffer = activeUnit = UNKNOWN;
+				depthFunc = depthMask = blendSource = blendDestination = UNKNOWN;
+				for (int i = 0; i < BUFFER_SLOT_COUNT; i++)
+					buffers[i] = UNKNOWN;
+				for (GLuint unit = 0; unit < GLState::MAX_TEXTURE_UNITS; unit++)
+					for (int i = 0; i < TEXTURE_SLOT_COUNT; i++)
+						textures[unit][i] = UNKNOWN;
+				for (int i = 0; i < CAP_SLOT_COUNT; i++)
+					capabilities[i] = UNKNOWN;
+			}
+
+			//true if gl needs the call, updates the cache either way
+			bool change(GLuint& cached, GLuint value)
+			{
+				if (cached == value)
+				{
+					elided++;
+					return false;
+				}
+				cached = value;
+				issued++;
+				return true;
+			}
+		};
+
+		State state;
+
+		int bufferSlot(GLenum target)
+		{
+			switch (target)
+			{
+			case GL_ARRAY_BUFFER: return BUFFER_ARRAY;
+			case GL_ELEMENT_ARRAY_BUFFER: return BUFFER_ELEMENT_ARRAY;
+			case GL_UNIFORM_BUFFER: return BUFFER_UNIFORM;
+			case GL_TEXTURE_BUFFER: return BUFFER_TEXTURE;
+			case GL_PIXEL_PACK_BUFFER: return BUFFER_PIXEL_PACK;
+			case GL_PIXEL_UNPACK_BUFFER: return BUFFER_PIXEL_UNPACK;
+			case GL_COPY_READ_BUFFER: return BUFFER_COPY_READ;
+			case GL_COPY_WRITE_BUFFER: return BUFFER_COPY_WRITE;
+			default: return -1;
+			}
+		}
+
+		int textureSlot(GLenum target)
+		{
+			switch (target)
+			{
+			case GL_TEXTURE_2D: return TEXTURE_2D;
+			case GL_TEXTURE_2D_ARRAY: return TEXTURE_2D_ARRAY;
+			case GL_TEXTURE_CUBE_MAP: return TEXTURE_CUBE_MAP;
+			case GL_TEXTURE_BUFFER: return TEXTURE_BUFFER;
+			default: return -1;
+			}
+		}
+
+		int capabilitySlot(GLenum capability)
+		{
+			switch (capability)
+			{
+			case GL_BLEND: return CAP_BLEND;
+			case GL_DEPTH_TEST: return CAP_DEPTH_TEST;
+			case GL_STENCIL_TEST: return CAP_STENCIL_TEST;
+			case GL_CULL_FACE: return CAP_CULL_FACE;
+			case GL_DEPTH_CLAMP: return CAP_DEPTH_CLAMP;
+			default: return -1;
+			}
+		}
+
+		void setCapability(GLenum capability, bool enabled)
+		{
+			int slot = capabilitySlot(capability);
+			if (slot < 0 || state.change(state.capabilities[slot], enabled ? GL_TRUE : GL_FALSE))
+			{
+				if (enabled)
+					glEnable(capability);
+				else
+					glDisable(capability);
+			}
+		}
+	}
+
+	void GLState::useProgram(GLuint program)
+	{
+		if (state.change(state.program, program))
+		{
+			glUseProgram(program);
+		}
+	}
+
+	void GLState::bindVertexArray(GLuint vertexArray)
+	{
+		if (state.change(state.vertexArray, vertexArray))
+		{
+			glBindVertexArray(vertexArray);
+			state.buffers[BUFFER_ELEMENT_ARRAY] = UNKNOWN;
+		}
+	}
+
+	void GLState::bindBuffer(GLenum target, GLuint buffer)
+	{
+		int slot = bufferSlot(target);
+		if (slot < 0 || state.change(state.buffers[slot], buffer))
+		{
+			glBindBuffer(target, buffer);
+		}
+	}
+
+	void GLState::bindBufferBase(GLenum target, GLuint index, GLuint buffer)
+	{
+		//indexed bindings aren't cached, only the generic one it overwrites
+		glBindBufferBase(target, index, buffer);
+		state.issued++;
+		int slot = bufferSlot(target);
+		if (slot >= 0)
+		{
+			state.buffers[slot] = buffer;
+		}
+	}
+
+	void GLState::bindBufferRange(GLenum target, GLuint index, GLuint buffer, GLintptr offset, GLsizeiptr size)
+	{
+		glBindBufferRange(target, index, buffer, offset, size);
+		state.issued++;
+		int slot = bufferSlot(target);
+		if (slot >= 0)
+		{
+			state.buffers[slot] = buffer;
+		}
+	}
+
+	void GLState::bindFramebuffer(GLuint framebuffer)
+	{
+		if (state.change(state.framebuffer, framebuffer))
+		{
+			glBindFramebuffer(GL_FRAMEBUFFER, framebuffer);
+		}
+	}
+
+	void GLState::activeTexture(GLenum unit)
+	{
+		if (state.change(state.activeUnit, unit - GL_TEXTURE0))
+		{
+			glActiveTexture(unit);
+		}
+	}
+
+	void GLState::bindTexture(GLenum target, GLuint texture)
+	{
+		int slot = textureSlot(target);
+		if (slot < 0 || state.activeUnit >= MAX_TEXTURE_UNITS)
+		{
+			glBindTexture(target, texture);
+			state.issued++;
+			//landed on some unit, none of them can be trusted for this target
+			if (slot >= 0 && state.activeUnit == UNKNOWN)
+			{
+				for (GLuint unit = 0; unit < MAX_TEXTURE_UNITS; unit++)
+					state.textures[unit][slot] = UNKNOWN;
+			}
+			return;
+		}
+		if (state.change(state.textures[state.activeUnit][slot], texture))
+		{
+			glBindTexture(target, texture);
+		}
+	}
+
+	void GLState::bindTexture(GLuint unit, GLenum target, GLuint texture)
+	{
+		int slot = textureSlot(target);
+		if (slot >= 0 && unit < MAX_TEXTURE_UNITS && state.textures[unit][slot] == texture)
+		{
+			state.elided++;
+			return;
+		}
+		activeTexture(GL_TEXTURE0 + unit);
+		bindTexture(target, texture);
+	}
+
+	void GLState::enable(GLenum capability)
+	{
+		setCapability(capability, true);
+	}
+
+	void GLState::disable(GLenum capability)
+	{
+		setCapability(capability, false);
+	}
+
+	void GLState::depthFunc(GLenum func)
+	{
+		if (state.change(state.depthFunc, func))
+		{
+			glDepthFunc(func);
+		}
+	}
+
+	void GLState::depthMask(GLboolean mask)
+	{
+		if (state.change(state.depthMask, mask))
+		{
+			glDepthMask(mask);
+		}
+	}
+
+	void GLState::blendFunc(GLenum source, GLenum destination)
+	{
+		if (state.blendSource == source && state.blendDestination == destination)
+		{
+			state.elided++;
+			return;
+		}
+		state.blendSource = source;
+		state.blendDestination = destination;
+		state.issued++;
+		glBlendFunc(source, destination);
+	}
+
+	void GLState::deleteProgram(GLuint program)
+	{
+		//a program in use lives on until something else is used, don't trust the cache either way
+		if (state.program == program)
+		{
+			state.program = UNKNOWN;
+		}
+		glDeleteProgram(program);
+	}
+
+	void GLState::deleteVertexArrays(GLsizei count, const GLuint* vertexArrays)
+	{
+		for (GLsizei i = 0; i < count; i++)
+		{
+			if (vertexArrays[i] != 0 && state.vertexArray == vertexArrays[i])
+			{
+				state.vertexArray = 0;
+				state.buffers[BUFFER_ELEMENT_ARRAY] = 0;
+			}
+		}
+		glDeleteVertexArrays(count, vertexArrays);
+	}
+
+	void GLState::deleteBuffers(GLsizei count, const GLuint* buffers)
+	{
+		for (GLsizei i = 0; i < count; i++)
+		{
+			for (int slot = 0; slot < BUFFER_SLOT_COUNT; slot++)
+			{
+				if (buffers[i] != 0 && state.buffers[slot] == buffers[i])
+				{
+					state.buffers[slot] = 0;
+				}
+			}
+		}
+		glDeleteBuffers(count, buffers);
+	}
+
+	void GLState::deleteFramebuffers(GLsizei count, const GLuint* framebuffers)
+	{
+		for (GLsizei i = 0; i < count; i++)
+		{
+			if (framebuffers[i] != 0 && state.framebuffer == framebuffers[i])
+			{
+				state.framebuffer = 0;
+			}
+		}
+		glDeleteFramebuffers(count, framebuffers);
+	}
+
+	void GLState::deleteTextures(GLsizei count, const GLuint* textures)
+	{
+		for (GLsizei i = 0; i < count; i++)
+		{
+			for (GLuint unit = 0; unit < MAX_TEXTURE_UNITS; unit++)
+			{
+				for (int slot = 0; slot < TEXTURE_SLOT_COUNT; slot++)
+				{
+					if (textures[i] != 0 && state.textures[unit][slot] == textures[i])
+					{
+						state.textures[unit][slot] = 0;
+					}
+				}
+			}
+		}
+		glDeleteTextures(count, textures);
+	}
+
+	void GLState::invalidate()
+	{
+		state.forget();
+	}
+
+	unsigned int GLState::getIssuedCount()
+	{
+		return state.issued;
+	}
+
+	unsigned int GLState::getElidedCount()
+	{
+		return state.elided;
+	}
+
+	void GLState::resetCounters()
+	{
+		state.issued = 0;
+		state.elided = 0;
+	}
+
+}
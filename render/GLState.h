@@ -0,0 +1,53 @@
+#pragma once
+
+#include "RenderResource.h"
+#include <GL/glew.h>
+
+namespace ginkgo {
+
+	//shadow copy of the bind points and fixed function state the render module touches
+	//every change goes through here and is dropped when gl already holds that value, one context only
+	//anything the cache doesn't know about (a target or capability it doesn't track) is passed straight through
+	class GLState
+	{
+	public:
+		static const GLuint MAX_TEXTURE_UNITS = 16;
+
+		static void useProgram(GLuint program);
+		static void bindVertexArray(GLuint vertexArray);
+		//GL_ELEMENT_ARRAY_BUFFER is vertex array state, it's forgotten whenever the vertex array changes
+		static void bindBuffer(GLenum target, GLuint buffer);
+		//also binds the generic target, as gl does
+		static void bindBufferBase(GLenum target, GLuint index, GLuint buffer);
+		static void bindBufferRange(GLenum target, GLuint index, GLuint buffer, GLintptr offset, GLsizeiptr size);
+		static void bindFramebuffer(GLuint framebuffer);
+
+		static void activeTexture(GLenum unit);
+		//on the active unit
+		static void bindTexture(GLenum target, GLuint texture);
+		//only switches the active unit if the binding on that unit actually changes
+		static void bindTexture(GLuint unit, GLenum target, GLuint texture);
+
+		static void enable(GLenum capability);
+		static void disable(GLenum capability);
+		static void depthFunc(GLenum func);
+		static void depthMask(GLboolean mask);
+		static void blendFunc(GLenum source, GLenum destination);
+
+		//deleting a bound object unbinds it, these keep the cache in step
+		static void deleteProgram(GLuint program);
+		static void deleteVertexArrays(GLsizei count, const GLuint* vertexArrays);
+		static void deleteBuffers(GLsizei count, const GLuint* buffers);
+		static void deleteFramebuffers(GLsizei count, const GLuint* framebuffers);
+		static void deleteTextures(GLsizei count, const GLuint* textures);
+
+		//forget everything, the next change of each kind always reaches gl (after a context switch or foreign gl code)
+		static void invalidate();
+
+		//since the last resetCounters
+		static unsigned int getIssuedCount();
+		static unsigned int getElidedCount();
+		static void resetCounters();
+	};
+
+}
@@ -0,0 +1,221 @@
+#include <iostream>
+#include <cmath>
+
+#include "GlyphAtlas.h"
+#include "GLState.h"
+
+namespace ginkgo {
+
+	namespace
+	{
+		//offset from a pixel to the nearest seed pixel found so far
+		struct SeedOffset
+		{
+			int dx;
+			int dy;
+			int squared() const { return dx * dx + dy * dy; }
+		};
+		//further than any glyph bitmap, small enough that squared can't overflow
+		const SeedOffset NO_SEED = { 10000, 10000 };
+
+		//8SSEDT, each pixel takes a neighbour's offset whenever that leads to a closer seed
+		//two sweeps over the grid, so linear in its size where searching a window around every texel is not
+		void distanceTransform(vector<SeedOffset>& grid, int width, int height)
+		{
+			auto compare = [&grid, width, height](SeedOffset& p, int x, int y, int offsetX, int offsetY)
+			{
+				x += offsetX;
+				y += offsetY;
+				if (x < 0 || y < 0 || x >= width || y >= height)
+					return;
+				SeedOffset other = grid[y * width + x];
+				other.dx += offsetX;
+				other.dy += offsetY;
+				if (other.squared() < p.squared())
+					p = other;
+			};
+
+			for (int y = 0; y < height; y++)
+			{
+				for (int x = 0; x < width; x++)
+				{
+					SeedOffset p = grid[y * width + x];
+					compare(p, x, y, -1, 0);
+					compare(p, x, y, 0, -1);
+					compare(p, x, y, -1, -1);
+					compare(p, x, y, 1, -1);
+					grid[y * width + x] = p;
+				}
+				for (int x = width - 1; x >= 0; x--)
+				{
+					SeedOffset p = grid[y * width + x];
+					compare(p, x, y, 1, 0);
+					grid[y * width + x] = p;
+				}
+			}
+			for (int y = height - 1; y >= 0; y--)
+			{
+				for (int x = width - 1; x >= 0; x--)
+				{
+					SeedOffset p = grid[y * width + x];
+					compare(p, x, y, 1, 0);
+					compare(p, x, y, 0, 1);
+					compare(p, x, y, -1, 1);
+					compare(p, x, y, 1, 1);
+					grid[y * width + x] = p;
+				}
+				for (int x = 0; x < width; x++)
+				{
+					SeedOffset p = grid[y * width + x];
+					compare(p, x, y, -1, 0);
+					grid[y * width + x] = p;
+				}
+			}
+		}
+	}
+
+	GlyphAtlas::GlyphAtlas(const char* fontFilePath)
+		: library(nullptr), face(nullptr), shelfX(0), shelfY(0), shelfHeight(0), reportedFull(false)
+	{
+		if (FT_Init_FreeType(&library))
+			std::cout << "ERROR::FREETYPE: Could not init FreeType Library" << std::endl;
+		else if (FT_New_Face(library, fontFilePath, 0, &face))
+			std::cout << "ERROR::FREETYPE: Failed to load font" << std::endl;
+		else
+			FT_Set_Pixel_Sizes(face, 0, SDF_SIZE * SDF_UPSAMPLE);
+
+		glGenTextures(1, &texture);
+		GLState::bindTexture(GL_TEXTURE_2D, texture);
+		glTexImage2D(GL_TEXTURE_2D, 0, GL_R8, ATLAS_SIZE, ATLAS_SIZE, 0, GL_RED, GL_UNSIGNED_BYTE, NULL);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+		GLState::bindTexture(GL_TEXTURE_2D, 0);
+
+		//printable ascii up front, so the usual text never rasterizes mid frame
+		if (face != nullptr)
+		{
+			for (unsigned int codePoint = 32; codePoint < 127; codePoint++)
+			{
+				getGlyph(codePoint);
+			}
+		}
+	}
+
+	GlyphAtlas::~GlyphAtlas()
+	{
+		GLState::deleteTextures(1, &texture);
+		if (face != nullptr)
+			FT_Done_Face(face);
+		if (library != nullptr)
+			FT_Done_FreeType(library);
+	}
+
+	const Glyph& GlyphAtlas::getGlyph(unsigned int codePoint)
+	{
+		auto it = glyphs.find(codePoint);
+		if (it != glyphs.end())
+		{
+			return it->second;
+		}
+		Glyph glyph = { vec2(), vec2(), vec4(), 0.0f };
+		if (!rasterize(codePoint, glyph))
+		{
+			unplaced = glyph;
+			return unplaced;
+		}
+		return glyphs[codePoint] = glyph;
+	}
+
+	bool GlyphAtlas::rasterize(unsigned int codePoint, Glyph& glyph)
+	{
+		if (face == nullptr || FT_Load_Char(face, codePoint, FT_LOAD_RENDER))
+		{
+			std::cout << "ERROR::FREETYTPE: Failed to load Glyph" << std::endl;
+			return true;
+		}
+
+		const FT_Bitmap& bitmap = face->glyph->bitmap;
+		const int upsample = SDF_UPSAMPLE;
+		const int spread = SDF_SPREAD;
+		glyph.advance = (face->glyph->advance.x >> 6) / (float)upsample;
+		if (bitmap.width == 0 || bitmap.rows == 0)
+		{
+			//whitespace, nothing to draw
+			return true;
+		}
+
+		GLint width = (bitmap.width + upsample - 1) / upsample + 2 * spread;
+		GLint height = (bitmap.rows + upsample - 1) / upsample + 2 * spread;
+		if (shelfX + width > ATLAS_SIZE)
+		{
+			shelfX = 0;
+			shelfY += shelfHeight + 1;
+			shelfHeight = 0;
+		}
+		if (shelfY + height > ATLAS_SIZE)
+		{
+			if (!reportedFull)
+			{
+				std::cout << "Glyph atlas is full, character " << codePoint << " and any others that don't fit are left blank!" << std::endl;
+				reportedFull = true;
+			}
+			return false;
+		}
+
+		//hi-res grid over the whole cell, the bitmap sits radius pixels in from each side
+		//seeding the inside pixels gives every outside pixel its distance to the outline, and the other way round
+		const int radius = spread * upsample;
+		const int gridWidth = width * upsample;
+		const int gridHeight = height * upsample;
+		vector<SeedOffset> toInside(gridWidth * gridHeight, NO_SEED);
+		vector<SeedOffset> toOutside(gridWidth * gridHeight, NO_SEED);
+		for (int y = 0; y < gridHeight; y++)
+		{
+			for (int x = 0; x < gridWidth; x++)
+			{
+				int bitmapX = x - radius;
+				int bitmapY = y - radius;
+				bool in = bitmapX >= 0 && bitmapY >= 0 && bitmapX < (int)bitmap.width && bitmapY < (int)bitmap.rows &&
+					bitmap.buffer[bitmapY * bitmap.pitch + bitmapX] >= 128;
+				SeedOffset seed = { 0, 0 };
+				((in) ? toInside : toOutside)[y * gridWidth + x] = seed;
+			}
+		}
+		distanceTransform(toInside, gridWidth, gridHeight);
+		distanceTransform(toOutside, gridWidth, gridHeight);
+
+		//each texel's distance to the nearest hi-res pixel on the other side of the outline, capped at the spread
+		vector<unsigned char> field(width * height);
+		for (GLint y = 0; y < height; y++)
+		{
+			for (GLint x = 0; x < width; x++)
+			{
+				int center = (y * upsample + upsample / 2) * gridWidth + x * upsample + upsample / 2;
+				bool in = toInside[center].squared() == 0;
+				int nearest = ((in) ? toOutside : toInside)[center].squared();
+				float distance = glm::min(std::sqrt((float)nearest) / upsample, (float)spread);
+				float value = 0.5f + ((in) ? distance : -distance) / (2.0f * spread);
+				field[y * width + x] = (unsigned char)(glm::clamp(value, 0.0f, 1.0f) * 255.0f + 0.5f);
+			}
+		}
+
+		GLint alignment;
+		glGetIntegerv(GL_UNPACK_ALIGNMENT, &alignment);
+		glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+		GLState::bindTexture(GL_TEXTURE_2D, texture);
+		glTexSubImage2D(GL_TEXTURE_2D, 0, shelfX, shelfY, width, height, GL_RED, GL_UNSIGNED_BYTE, &field[0]);
+		GLState::bindTexture(GL_TEXTURE_2D, 0);
+		glPixelStorei(GL_UNPACK_ALIGNMENT, alignment);
+
+		glyph.offset = vec2(face->glyph->bitmap_left / (float)upsample - spread, face->glyph->bitmap_top / (float)upsample + spread);
+		glyph.size = vec2((float)width, (float)height);
+		glyph.uvRect = vec4(shelfX, shelfY, shelfX + width, shelfY + height) / (float)ATLAS_SIZE;
+
+		shelfX += width + 1;
+		shelfHeight = glm::max(shelfHeight, height);
+		return true;
+	}
+
+}
@@ -0,0 +1,60 @@
+#pragma once
+
+#include "RenderResource.h"
+#include <GL/glew.h>
+#include <ft2build.h>
+#include <freetype/freetype.h>
+#include <unordered_map>
+
+namespace ginkgo {
+
+	//in atlas pixels at SDF_SIZE, scale by (font size / SDF_SIZE) when laying out
+	struct Glyph
+	{
+		vec2 offset; //pen position to the quad's left and top
+		vec2 size; //quad, including the distance field's spread
+		vec4 uvRect; //left, top, right, bottom
+		float advance;
+	};
+
+	//one font's glyphs as a signed distance field in a single texture, printable ascii when it is made, anything else the first time it is asked for
+	//one atlas serves every scale, the shader thresholds the distance at 0.5
+	//there is only the one page, ATLAS_SIZE holds several hundred glyphs at SDF_SIZE, plenty for latin scripts
+	//but not for CJK, glyphs past that are left blank
+	class GlyphAtlas
+	{
+	private:
+		FT_Library library;
+		FT_Face face;
+		GLuint texture;
+		std::unordered_map<unsigned int, Glyph> glyphs;
+
+		//shelf packer state
+		GLint shelfX;
+		GLint shelfY;
+		GLint shelfHeight;
+
+		//a glyph that didn't fit, kept out of glyphs so it gets another try
+		Glyph unplaced;
+		bool reportedFull;
+
+		//false if the atlas is full, glyph then only has its advance
+		bool rasterize(unsigned int codePoint, Glyph& glyph);
+	public:
+		static const GLsizei ATLAS_SIZE = 1024;
+		static const unsigned int SDF_SIZE = 32; //em size the field is stored at
+		static const unsigned int SDF_UPSAMPLE = 4; //outlines are rendered this much larger and the field is measured on that
+		static const unsigned int SDF_SPREAD = 4; //texels the field reaches past the outline
+
+		GlyphAtlas(const char* fontFilePath);
+		~GlyphAtlas();
+		GlyphAtlas(const GlyphAtlas&) = delete;
+		GlyphAtlas& operator=(const GlyphAtlas&) = delete;
+
+		//may upload into the atlas, render thread only
+		//a glyph that didn't fit comes back empty and is only valid until the next call
+		const Glyph& getGlyph(unsigned int codePoint);
+		GLuint getTexture() const { return texture; }
+	};
+
+}
@@ -0,0 +1,220 @@
+#include <iostream>
+
+#include "HeadlessWindow.h"
+
+#ifndef _WIN32
+
+#include "GLState.h"
+#include "FileUtils.h"
+
+#include <EGL/egl.h>
+#include <EGL/eglext.h>
+#ifdef GINKGO_OSMESA
+#include <GL/osmesa.h>
+#endif
+
+#ifndef EGL_PLATFORM_SURFACELESS_MESA
+#define EGL_PLATFORM_SURFACELESS_MESA 0x31DD
+#endif
+
+namespace ginkgo {
+
+	HeadlessWindow::HeadlessWindow(int width, int height, const vec4& clear_color)
+		: width(width), height(height), clear_color(clear_color), frameCount(0), frameLimit(0),
+		display(nullptr), surface(nullptr), context(nullptr), osmesaContext(nullptr)
+	{
+	}
+
+	HeadlessWindow::~HeadlessWindow()
+	{
+		if (display)
+		{
+			eglMakeCurrent(display, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT);
+			if (context)
+				eglDestroyContext(display, context);
+			if (surface)
+				eglDestroySurface(display, surface);
+			eglTerminate(display);
+		}
+#ifdef GINKGO_OSMESA
+		if (osmesaContext)
+			OSMesaDestroyContext((OSMesaContext)osmesaContext);
+#endif
+	}
+
+	bool HeadlessWindow::initEGL()
+	{
+		//surfaceless needs no X or gbm device at all, plain eglGetDisplay works too where mesa can find one
+		EGLDisplay eglDisplay = EGL_NO_DISPLAY;
+		PFNEGLGETPLATFORMDISPLAYEXTPROC getPlatformDisplay = (PFNEGLGETPLATFORMDISPLAYEXTPROC)eglGetProcAddress("eglGetPlatformDisplayEXT");
+		if (getPlatformDisplay)
+			eglDisplay = getPlatformDisplay(EGL_PLATFORM_SURFACELESS_MESA, EGL_DEFAULT_DISPLAY, NULL);
+		if (eglDisplay == EGL_NO_DISPLAY)
+			eglDisplay = eglGetDisplay(EGL_DEFAULT_DISPLAY);
+		if (eglDisplay == EGL_NO_DISPLAY || !eglInitialize(eglDisplay, NULL, NULL))
+		{
+			std::cout << "Failed to initialize an EGL display!" << std::endl;
+			return false;
+		}
+		display = eglDisplay;
+
+		const EGLint configAttributes[] = {
+			EGL_SURFACE_TYPE, EGL_PBUFFER_BIT,
+			EGL_RENDERABLE_TYPE, EGL_OPENGL_BIT,
+			EGL_RED_SIZE, 8, EGL_GREEN_SIZE, 8, EGL_BLUE_SIZE, 8, EGL_ALPHA_SIZE, 8,
+			EGL_DEPTH_SIZE, 24, EGL_STENCIL_SIZE, 8,
+			EGL_NONE
+		};
+		EGLConfig config;
+		EGLint configCount = 0;
+		if (!eglChooseConfig(eglDisplay, configAttributes, &config, 1, &configCount) || configCount == 0)
+		{
+			std::cout << "No EGL config for a headless window!" << std::endl;
+			return false;
+		}
+
+		//a pbuffer gives the renderer a real framebuffer 0 to draw and read back from
+		const EGLint surfaceAttributes[] = { EGL_WIDTH, (EGLint)width, EGL_HEIGHT, (EGLint)height, EGL_NONE };
+		surface = eglCreatePbufferSurface(eglDisplay, config, surfaceAttributes);
+		if (surface == EGL_NO_SURFACE)
+		{
+			surface = nullptr;
+			std::cout << "Failed to create an EGL pbuffer!" << std::endl;
+			return false;
+		}
+
+		eglBindAPI(EGL_OPENGL_API);
+		const EGLint contextAttributes[] = {
+			EGL_CONTEXT_MAJOR_VERSION_KHR, 3,
+			EGL_CONTEXT_MINOR_VERSION_KHR, 3,
+			EGL_CONTEXT_OPENGL_PROFILE_MASK_KHR, EGL_CONTEXT_OPENGL_CORE_PROFILE_BIT_KHR,
+			EGL_NONE
+		};
+		context = eglCreateContext(eglDisplay, config, EGL_NO_CONTEXT, contextAttributes);
+		if (context == EGL_NO_CONTEXT)
+		{
+			context = nullptr;
+			std::cout << "Failed to create an EGL 3.3 context!" << std::endl;
+			return false;
+		}
+		if (!eglMakeCurrent(eglDisplay, surface, surface, context))
+		{
+			std::cout << "Failed to make the EGL context current!" << std::endl;
+			return false;
+		}
+		return true;
+	}
+
+	bool HeadlessWindow::initOSMesa()
+	{
+#ifdef GINKGO_OSMESA
+		const int attributes[] = {
+			OSMESA_FORMAT, OSMESA_RGBA,
+			OSMESA_DEPTH_BITS, 24,
+			OSMESA_STENCIL_BITS, 8,
+			OSMESA_PROFILE, OSMESA_CORE_PROFILE,
+			OSMESA_CONTEXT_MAJOR_VERSION, 3,
+			OSMESA_CONTEXT_MINOR_VERSION, 3,
+			0
+		};
+		OSMesaContext osmesa = OSMesaCreateContextAttribs(attributes, NULL);
+		if (!osmesa)
+		{
+			std::cout << "Failed to create an OSMesa 3.3 context!" << std::endl;
+			return false;
+		}
+		osmesaContext = osmesa;
+
+		osmesaBuffer.resize(4 * width * height);
+		if (!OSMesaMakeCurrent(osmesa, osmesaBuffer.data(), GL_UNSIGNED_BYTE, width, height))
+		{
+			std::cout << "Failed to make the OSMesa context current!" << std::endl;
+			return false;
+		}
+		return true;
+#else
+		return false;
+#endif
+	}
+
+	bool HeadlessWindow::init()
+	{
+		if (!initEGL() && !initOSMesa())
+		{
+			std::cout << "Failed to create a headless context!" << std::endl;
+			return false;
+		}
+
+		//this glew loads through glXGetProcAddress, which glvnd routes to the current EGL context without an X display
+		//OSMesa builds need a glew built with GLEW_OSMESA instead
+		glewExperimental = GL_TRUE;
+		if (glewInit() != GLEW_OK)
+		{
+			std::cout << "Could not initialize GLEW!" << std::endl;
+			return false;
+		}
+		glGetError(); //glewExperimental leaves an enum error behind on core contexts
+
+		std::cout << "OpenGL " << glGetString(GL_VERSION) << " (" << glGetString(GL_RENDERER) << ")" << std::endl;
+
+		//same defaults as Window::init
+		glFrontFace(GL_CW);
+		glCullFace(GL_BACK);
+		GLState::enable(GL_DEPTH_CLAMP);
+		glViewport(0, 0, width, height);
+
+		return true;
+	}
+
+	void HeadlessWindow::update() const
+	{
+		if (frameDumpHook)
+		{
+			GLState::bindFramebuffer(0);
+			GLState::bindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+			glPixelStorei(GL_PACK_ALIGNMENT, 1);
+			dumpPixels.resize(3 * width * height);
+			glReadPixels(0, 0, width, height, GL_BGR, GL_UNSIGNED_BYTE, dumpPixels.data());
+			frameDumpHook(dumpPixels.data(), width, height, frameCount);
+		}
+
+		if (surface)
+			eglSwapBuffers(display, surface);
+		else
+			glFinish(); //OSMesa renders straight into osmesaBuffer, finishing is the swap
+
+		frameCount++;
+	}
+
+	void HeadlessWindow::dumpFramesTo(const string& prefix)
+	{
+		frameDumpHook = [prefix](const unsigned char* pixels, unsigned int width, unsigned int height, unsigned int frame)
+		{
+			FileUtils::saveImage((prefix + std::to_string(frame) + ".png").c_str(), pixels, width, height);
+		};
+	}
+
+	IHeadlessWindow* headlessWindowFactory(int width, int height, const vec4& clear_color)
+	{
+		HeadlessWindow* window = new HeadlessWindow(width, height, clear_color);
+		if (!window->init())
+		{
+			delete window;
+			return nullptr;
+		}
+		return window;
+	}
+}
+
+#else
+
+namespace ginkgo {
+	//EGL and OSMesa are linux only, windows builds get no headless window
+	IHeadlessWindow* headlessWindowFactory(int, int, const vec4&)
+	{
+		std::cout << "Headless windows need EGL or OSMesa, not available on this platform!" << std::endl;
+		return nullptr;
+	}
+}
+
+#endif
\ No newline at end of file
@@ -0,0 +1,60 @@
+#pragma once
+
+#include "IHeadlessWindow.h"
+
+namespace ginkgo {
+
+	class HeadlessWindow : public IHeadlessWindow
+	{
+	private:
+		unsigned int width, height;
+		vec4 clear_color;
+		mutable unsigned int frameCount; //update is const in IWindow
+		unsigned int frameLimit;
+		FrameDumpHook frameDumpHook;
+		mutable vector<unsigned char> dumpPixels;
+
+		//EGL or OSMesa handles, kept opaque so this header needs neither
+		void* display;
+		void* surface;
+		void* context;
+		void* osmesaContext;
+		vector<unsigned char> osmesaBuffer; //OSMesa's default framebuffer
+
+		bool initEGL();
+		bool initOSMesa();
+	public:
+		HeadlessWindow(int width, int height, const vec4& clear_color);
+		~HeadlessWindow();
+
+		//false if no context could be made, the window is then unusable
+		bool init();
+
+		void update() const override;
+		bool closed() const override { return frameLimit != 0 && frameCount >= frameLimit; }
+
+		unsigned int getWidth() const override { return width; }
+		unsigned int getHeight() const override { return height; }
+		float getAspectRatio() const override { return (float)width / (float)height; }
+		const vec4& getClearColor() const override { return clear_color; }
+
+		void setClearColor(const vec4& color) override { clear_color = color; }
+
+		bool isKeyPressed(unsigned int) const override { return false; }
+		bool isMouseButtonPressed(unsigned int) const override { return false; }
+		void getMousePosition(double& x, double& y) const override { x = width / 2.0; y = height / 2.0; }
+		void getScrollOffset(double& xoffset, double& yoffset) const override { xoffset = 0; yoffset = 0; }
+
+		void disableMouseCursor() const override {}
+		void enableMouseCursor() const override {}
+		void setMousePosition(double, double) const override {}
+
+		GLFWwindow* getInternalWindow() override { return nullptr; }
+
+		void setFrameDumpHook(const FrameDumpHook& hook) override { frameDumpHook = hook; }
+		void dumpFramesTo(const string& prefix) override;
+		void setFrameLimit(unsigned int frames) override { frameLimit = frames; }
+		unsigned int getFrameCount() const override { return frameCount; }
+	};
+
+}
@@ -15,8 +15,8 @@ namespace ginkgo
 	{
 	public:
 		virtual void draw(const mat4& transformProjectionView) const = 0;
-		virtual void bindCubeMapTexture() const = 0;
-		virtual void unbindCubeMapTexture() const = 0;
+		//left bound, later binds on the same unit replace it
+		virtual void bindCubeMapTexture(unsigned int unit) const = 0;
 
 		virtual ~ICubeMap() = 0;
 	};
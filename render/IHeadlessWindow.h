@@ -0,0 +1,30 @@
+#pragma once
+
+#include "IWindow.h"
+#include <functional>
+
+namespace ginkgo
+{
+	//pixels are BGR, bottom row first, as FileUtils::screenshot reads them
+	typedef std::function<void(const unsigned char* pixels, unsigned int width, unsigned int height, unsigned int frame)> FrameDumpHook;
+
+	//an IWindow with no display behind it, for benchmarks and image comparisons in automation
+	//input always reads as idle, getInternalWindow is null
+	class IHeadlessWindow : public IWindow
+	{
+	public:
+		//called from update with each finished frame, before the next one starts
+		virtual void setFrameDumpHook(const FrameDumpHook& hook) = 0;
+		//a hook that writes <prefix><frame>.png
+		virtual void dumpFramesTo(const string& prefix) = 0;
+		//closed() turns true after this many updates, 0 never closes
+		virtual void setFrameLimit(unsigned int frames) = 0;
+		virtual unsigned int getFrameCount() const = 0;
+
+		virtual ~IHeadlessWindow() {}
+	};
+
+	//EGL pbuffer (Mesa's surfaceless platform where there is one) with OSMesa as the fallback, both run on llvmpipe
+	//Linux only, null if neither can make a 3.3 core context
+	DECLSPEC_RENDER IHeadlessWindow* headlessWindowFactory(int width, int height, const vec4& clear_color);
+}
@@ -18,11 +18,20 @@ namespace ginkgo
 		virtual void removeRenderable(int UID) = 0;
 		virtual IRenderable* alterRenderable(int UID) const = 0;
 		virtual const IRenderable* getRenderable(int UID) const = 0;
+		//replaces the given (never moving) renderables with merged per material chunks, returns the number of chunks
+		//the originals are only removed from the layer, not deleted
+		virtual unsigned int bakeStatic(const vector<int>& UIDs, float chunkSize) = 0;
 
 		virtual const mat4& getModel() const = 0;
 		virtual ITransform& alterModel() = 0;
 
-		virtual void draw(const mat4& transformProjectionView, const vec3& cameraPosition, const IPhongShader& phongShader, const ICubeMap& cubeMap) const = 0;
+		//view includes the camera translation, projection must be a perspective one (point lights are clustered in view space)
+		virtual void draw(const mat4& projection, const mat4& view, const vec3& cameraPosition, const IPhongShader& phongShader, const ICubeMap& cubeMap) const = 0;
+
+		///stats from the last draw
+		virtual unsigned int getDrawnCount() const = 0;
+		virtual unsigned int getCulledCount() const = 0;
+		virtual unsigned int getDrawCallCount() const = 0;
 
 		virtual ~ILayer() = 0;
 	};
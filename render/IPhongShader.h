@@ -10,7 +10,11 @@ namespace ginkgo
 	class IPhongShader
 	{
 	public:
-		virtual void updateUniforms(const mat4& model, const mat4& transformProjectionViewModel, const Material& material, const vec3& cameraPosition) const = 0;
+		//once per frame, uploads the view projection, lighting and the camera into the light uniform buffer
+		//and bins the point lights into view space clusters, projection must be a perspective one
+		virtual void updateFrameUniforms(const mat4& projection, const mat4& view, const vec3& cameraPosition) const = 0;
+		//once per draw, model matrices come from the instance buffer
+		virtual void updateUniforms(const Material& material) const = 0;
 
 		virtual const vec4& getAmbientLight() const = 0;
 		virtual void setAmbientLight(const vec4& ambientLight) = 0;
@@ -23,10 +27,14 @@ namespace ginkgo
 		virtual const DirectionalLight& getDirectionalLight() const = 0;
 		virtual void setDirectionalLight(const DirectionalLight& directionalLight) = 0;
 		virtual const PointLight& getPointLight(int index) = 0;
-
-		virtual void setUniform(const string& name, const DirectionalLight& directionalLight) const = 0;
-		virtual void setUniform(const string& name, const BaseLight& baseLight) const = 0;
-		virtual void setUniform(const string& name, const PointLight& pointLight) const = 0;
+		//point lights that reached the view in the last updateFrameUniforms
+		virtual unsigned int getVisiblePointLightCount() const = 0;
+
+		///quality knobs, see QualityGovernor
+		//added to the mip level of every diffuse texture, positive is blurrier and cheaper
+		virtual void setTextureLodBias(float bias) = 0;
+		//clusters reached by more lights keep the nearest ones
+		virtual void setMaxLightsPerCluster(unsigned int count) = 0;
 
 		virtual ~IPhongShader() = 0;
 	};
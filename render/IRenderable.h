@@ -24,6 +24,8 @@ namespace ginkgo
 		virtual const Material& getMaterial() const = 0;
 
 		virtual const int getIndex() const = 0;
+		//changes whenever the mesh or material is swapped for another, edits inside a shared material don't move it
+		virtual unsigned int getStateVersion() const = 0;
 
 		virtual void draw() const = 0;
 
@@ -9,17 +9,22 @@ namespace ginkgo
 	class IWindow;
 	struct DirectionalLight;
 	struct PointLight;
+	struct RenderSnapshot;
 
 	///wrapper for all renderer classes
 	class IRenderer
 	{
 	public:
 		///renderable management
+		//render thread, the simulation hands removals over with releaseRenderable
 		//returns the UID of this renderable for removal
 		virtual int addRenderable(IRenderable* renderable) = 0;
 		virtual void removeRenderable(int UID) = 0;
 		
 		virtual IRenderable* getRenderable(int UID) const = 0;
+		//call once the level is loaded, for renderables that will never move again
+		//they are merged into a few large meshes, chunkSize apart so culling still works
+		virtual unsigned int bakeStaticGeometry(const vector<int>& UIDs, float chunkSize = 64.0f) = 0;
 
 		///light management
 		virtual void setDirectionalLight(const DirectionalLight& directionalLight) = 0;
@@ -46,8 +51,46 @@ namespace ginkgo
 
 		virtual ICamera* getCamera() = 0;
 
+		///Quality
+		//resolution, texture detail and lights per cluster step down to hold the target and back up with headroom
+		//off by default, the target (60 Hz unless set) is measured against the frame's CPU and GPU work, not the time between swaps
+		virtual void setTargetFrameTime(double seconds) = 0;
+		//off goes back to, and stays at, full quality
+		virtual void setAdaptiveQuality(bool enabled) = 0;
+		//0 is full quality
+		virtual int getQualityLevel() const = 0;
+		//screen pass effects, without them (and at full resolution) the scene renders straight to the window
+		virtual void setPostProcessing(bool enabled) = 0;
+
+		///Simulation handoff (simulation thread only)
+		//clears and returns the snapshot being filled for the current tick
+		virtual RenderSnapshot& beginSnapshot() = 0;
+		virtual RenderSnapshot& getWriteSnapshot() = 0;
+		//makes the snapshot visible to renderAndSwap, which interpolates between the last two it has seen
+		virtual void publishSnapshot() = 0;
+		//any thread, takes the renderable out of the layer and deletes it on the render thread before the next frame draws
+		virtual void releaseRenderable(IRenderable* renderable) = 0;
+
 		virtual void renderAndSwap() = 0;
 
+		///Capture
+		//read back a frame or two late and written on a background thread, neither stalls rendering
+		//saves the next rendered frame, the format comes from the extension (.png, .bmp, ...)
+		virtual void screenshot(const string& path) = 0;
+		//appends every rendered frame to path as raw bgr24, bottom row first, for replays and video
+		virtual void startCapture(const string& path) = 0;
+		virtual void stopCapture() = 0;
+		//blocks until every captured frame is written, call before exiting
+		virtual void finishCaptures() = 0;
+
+		///stats from the last renderAndSwap
+		virtual unsigned int getDrawnCount() const = 0;
+		virtual unsigned int getCulledCount() const = 0;
+		virtual unsigned int getDrawCallCount() const = 0;
+		//binds and render state changes that reached gl, and those dropped because gl already had them
+		virtual unsigned int getStateChangeCount() const = 0;
+		virtual unsigned int getElidedStateChangeCount() const = 0;
+
 		virtual ~IRenderer() = 0;
 	};
 
@@ -8,7 +8,15 @@ namespace ginkgo
 	class IText
 	{
 	public:
+		//queues the text, nothing reaches the screen until flush
 		virtual void draw(const string& text, GLfloat x, GLfloat y, GLfloat scale, const vec3& color) = 0;
+		//everything queued since the last flush in one draw call
+		virtual void flush() = 0;
+
+		//laid out once and drawn by every flush until updated or released, returns the label's region
+		virtual unsigned int retain(const string& text, GLfloat x, GLfloat y, GLfloat scale, const vec3& color) = 0;
+		virtual void update(unsigned int region, const string& text, GLfloat x, GLfloat y, GLfloat scale, const vec3& color) = 0;
+		virtual void release(unsigned int region) = 0;
 
 		virtual float getMinCharWidth() const = 0;
 		virtual float getMaxCharWidth() const = 0;
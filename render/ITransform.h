@@ -19,6 +19,12 @@ namespace ginkgo
 		virtual vec3 const& getTranslation() const = 0;
 		virtual quat const& getRotation() const = 0;
 
+		//getMatrix becomes the parent's matrix times this one, for held items, wheels and the like, nullptr detaches
+		//parents update before their children once a frame, so attached transforms cost no more than loose ones
+		virtual void setParent(ITransform* parent) = 0;
+		//changes whenever getMatrix would return something new
+		virtual unsigned int getVersion() const = 0;
+
 		virtual ~ITransform() = 0;
 	};
 
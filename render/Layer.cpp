@@ -7,125 +7,279 @@
 #include "Texture.h"
 #include "Transform.h"
 #include "CubeMap.h"
+#include "Mesh.h"
+#include "Frustum.h"
+#include "StaticGeometry.h"
+#include "GLState.h"
 
 namespace ginkgo {
 
+	//instances a frame's section of the stream starts out with room for, grows past it as needed
+	static const unsigned int INITIAL_INSTANCES = 1024;
+
 	Layer::Layer(const vector<IRenderable*>& renderablesL)
-		: renderables(renderablesL)
+		: layerModelVersion(0), drawnCount(0), culledCount(0), drawCallCount(0), instanceStream(INITIAL_INSTANCES * sizeof(InstanceData))
 	{
-		if (renderablesL.size())
+		for (unsigned int i = 0; i < renderablesL.size(); i++)
 		{
-			return;
+			addRenderable(renderablesL[i]);
 		}
-		sort(renderables.begin(), renderables.end(), compareRenderables);
 	}
 
-	GLuint Layer::determineTextureID(IRenderable* r)
+	Layer::~Layer()
 	{
-		return (r->getMaterial().texture != nullptr) ?
-			r->getMaterial().texture->tid :
-			Layer::NO_TEXTURE;
+		for (unsigned int i = 0; i < bakes.size(); i++)
+		{
+			delete bakes[i];
+		}
 	}
 
-	bool Layer::compareRenderables(IRenderable* r1, IRenderable* r2)
+	SortKey Layer::makeStateKey(const IRenderable* r)
 	{
-		return determineTextureID(r1) < determineTextureID(r2);
+		const Material& material = r->getMaterial();
+		unsigned int pass = (material.refractiveIndex >= 0) ? SortKeys::PASS_REFRACTIVE : SortKeys::PASS_OPAQUE;
+		return SortKeys::make(pass, 0, material.getTextureID(), material.hash(), r->getMesh().getID(), 0);
+	}
+
+	bool Layer::sameBatch(const IRenderable* r1, const IRenderable* r2)
+	{
+		//layer and uv rect are per instance, so materials sharing a texture array batch together
+		return &r1->getMesh() == &r2->getMesh() && r1->getMaterial().canBatchWith(r2->getMaterial());
+	}
+
+	int Layer::findSlot(int UID) const
+	{
+		auto it = slots.find(UID);
+		return (it != slots.end()) ? (int)it->second : -1;
+	}
+
+	void Layer::invalidateModel(unsigned int slot) const
+	{
+		if (slot < modelVersions.size())
+		{
+			modelVersions[slot] = 0;
+		}
 	}
 
 	IRenderable* Layer::alterRenderable(int UID) const
 	{
-		if (UID < 0)
+		int slot = findSlot(UID);
+		return (slot >= 0) ? renderables[slot] : nullptr;
+	}
+
+	const IRenderable* Layer::getRenderable(int UID) const
+	{
+		int slot = findSlot(UID);
+		return (slot >= 0) ? renderables[slot] : nullptr;
+	}
+
+	const mat4& Layer::getModel() const
+	{
+		return model.getMatrix();
+	}
+
+	int Layer::addRenderable(IRenderable* renderable)
+	{
+		if (!slots.emplace(renderable->getIndex(), renderables.size()).second)
+		{
+			return renderable->getIndex();
+		}
+		renderables.emplace_back(renderable);
+		stateVersions.emplace_back(renderable->getStateVersion());
+		invalidateModel(renderables.size() - 1);
+		return renderable->getIndex();
+	}
+
+	void Layer::removeRenderable(int UID)
+	{
+		int slot = findSlot(UID);
+		if (slot < 0)
 		{
-			return nullptr;
+			return;
 		}
 
-		for (unsigned int i = 0; i < renderables.size(); i++)
+		unsigned int last = renderables.size() - 1;
+		if ((unsigned int)slot != last)
+		{
+			renderables[slot] = renderables[last];
+			stateVersions[slot] = stateVersions[last];
+			slots[renderables[slot]->getIndex()] = slot;
+			invalidateModel(slot);
+		}
+		renderables.pop_back();
+		stateVersions.pop_back();
+		slots.erase(UID);
+	}
+
+	unsigned int Layer::bakeStatic(const vector<int>& UIDs, float chunkSize)
+	{
+		vector<const IRenderable*> sources;
+		for (unsigned int i = 0; i < UIDs.size(); i++)
 		{
-			if (renderables[i]->getIndex() == UID)
+			const IRenderable* renderable = getRenderable(UIDs[i]);
+			if (renderable != nullptr)
 			{
-				return renderables[i];
+				sources.push_back(renderable);
 			}
 		}
-		return nullptr;
+		if (sources.empty())
+		{
+			return 0;
+		}
+
+		StaticGeometry* bake = new StaticGeometry(sources, chunkSize);
+		bakes.push_back(bake);
+
+		for (unsigned int i = 0; i < sources.size(); i++)
+		{
+			removeRenderable(sources[i]->getIndex());
+		}
+		for (unsigned int i = 0; i < bake->getChunks().size(); i++)
+		{
+			addRenderable(bake->getChunks()[i]);
+		}
+		return bake->getChunks().size();
 	}
 
-	const IRenderable* Layer::getRenderable(int UID) const
+	void Layer::cull(const mat4& transformProjectionView) const
 	{
-		if (UID < 0)
+		unsigned int count = renderables.size();
+		unsigned int padded = (count + 3) & ~3u;
+		cullX.resize(padded);
+		cullY.resize(padded);
+		cullZ.resize(padded);
+		cullRadius.resize(padded);
+		visible.resize(padded);
+		modelMatrices.resize(count);
+		modelVersions.resize(count, 0);
+		meshVersions.resize(count, 0);
+
+		//the whole layer moved, every cached matrix is stale
+		if (layerModelVersion != model.getVersion())
 		{
-			return nullptr;
+			layerModelVersion = model.getVersion();
+			std::fill(modelVersions.begin(), modelVersions.end(), 0);
 		}
 
-		for (unsigned int i = 0; i < renderables.size(); i++)
+		//bounding spheres into world space, only for what moved (or changed mesh, or had its mesh finish loading) since the last frame
+		for (unsigned int i = 0; i < count; i++)
 		{
-			if (renderables[i]->getIndex() == UID)
+			unsigned int version = renderables[i]->getTransform().getVersion();
+			const Mesh& mesh = renderables[i]->getMesh();
+			if (modelVersions[i] == version && stateVersions[i] == renderables[i]->getStateVersion() && meshVersions[i] == mesh.getDataVersion())
 			{
-				return renderables[i];
+				continue;
 			}
+			modelVersions[i] = version;
+			stateVersions[i] = renderables[i]->getStateVersion();
+			meshVersions[i] = mesh.getDataVersion();
+			const mat4& m = modelMatrices[i] = model.getMatrix() * renderables[i]->getModel();
+			vec4 center = m * vec4(mesh.getBoundingSphereCenter(), 1.0f);
+			float scale = glm::max(glm::length(vec3(m[0])), glm::max(glm::length(vec3(m[1])), glm::length(vec3(m[2]))));
+			cullX[i] = center.x;
+			cullY[i] = center.y;
+			cullZ[i] = center.z;
+			cullRadius[i] = mesh.getBoundingSphereRadius() * scale;
+		}
+		for (unsigned int i = count; i < padded; i++)
+		{
+			cullX[i] = cullY[i] = cullZ[i] = cullRadius[i] = 0;
 		}
-		return nullptr;
-	}
 
-	const mat4& Layer::getModel() const
-	{
-		return model.getMatrix();
+		Frustum(transformProjectionView).cullSpheres(&cullX[0], &cullY[0], &cullZ[0], &cullRadius[0], count, &visible[0]);
 	}
 
-	//speed doesnt matter for this, just re-sort for each new addition
-	//if needed, change this to bsearch->insert
-	int Layer::addRenderable(IRenderable* renderable)
+	void Layer::buildQueue(const vec3& cameraPosition) const
 	{
-		renderables.emplace_back(renderable);
-		sort(renderables.begin(), renderables.end(), compareRenderables);
-		return renderable->getIndex();
-	}
+		queue.clear();
 
-	void Layer::removeRenderable(int UID)
-	{
+		float farthest = 0;
 		for (unsigned int i = 0; i < renderables.size(); i++)
 		{
-			if (renderables[i]->getIndex() == UID)
+			if (visible[i])
 			{
-				renderables.erase(renderables.begin() + i);
-				return;
+				farthest = glm::max(farthest, glm::distance(cameraPosition, vec3(cullX[i], cullY[i], cullZ[i])));
+			}
+		}
+		float depthScale = (farthest > 0) ? SortKeys::DEPTH_MAX / farthest : 0;
+
+		for (unsigned int i = 0; i < renderables.size(); i++)
+		{
+			if (!visible[i])
+			{
+				continue;
 			}
+			//rebuilt every frame, materials are shared and edited in place so nothing tells a renderable its material changed
+			//nearest first so opaque geometry fills the depth buffer early
+			unsigned int depth = (unsigned int)(glm::distance(cameraPosition, vec3(cullX[i], cullY[i], cullZ[i])) * depthScale);
+			queue.push(makeStateKey(renderables[i]) | depth, i);
 		}
+		queue.sort();
 	}
 
-	void Layer::draw(const mat4& transformProjectionView, const vec3& cameraPosition, const IPhongShader& phongShaderI, const ICubeMap& cubeMapI) const
+	void Layer::draw(const mat4& projection, const mat4& view, const vec3& cameraPosition, const IPhongShader& phongShaderI, const ICubeMap& cubeMapI) const
 	{
+		mat4 transformProjectionView = projection * view;
 		const PhongShader& phongShader = (const PhongShader&)phongShaderI;
 		const CubeMap& cubeMap = (const CubeMap&)cubeMapI;
 		phongShader.bind();
+		drawnCount = 0;
+		culledCount = 0;
+		drawCallCount = 0;
 		if (renderables.size() > 0)
 		{
-			phongShader.setUniform1i("diffuseTexture", 0); //dependant on phongFragment.fs
-			phongShader.setUniform1i("skybox", 1);		   //dependant on phongFragment.fs
-			GLuint currentTextureID = 0;
+			cull(transformProjectionView);
+
+			phongShader.updateFrameUniforms(projection, view, cameraPosition);
+
+			buildQueue(cameraPosition);
+			drawnCount = queue.size();
+			culledCount = renderables.size() - drawnCount;
+			if (drawnCount == 0)
+			{
+				return;
+			}
 
-			for (unsigned int i = 0; i < renderables.size(); i++)
+			//every instance this frame written straight into mapped memory, each batch then points the attributes at its own range
+			instanceStream.beginFrame();
+			GLintptr instanceOffset;
+			InstanceData* instances = (InstanceData*)instanceStream.allocate(drawnCount * sizeof(InstanceData), sizeof(vec4), instanceOffset);
+			for (unsigned int i = 0; i < drawnCount; i++)
 			{
-				if (determineTextureID(renderables[i]) != currentTextureID)
+				const IRenderable* r = renderables[queue[i].index];
+				const Mesh& mesh = r->getMesh();
+				//whole structs, mapped memory may be write combined
+				InstanceData instance;
+				instance.model = mesh.isQuantized() ? modelMatrices[queue[i].index] * mesh.getDequantization() : modelMatrices[queue[i].index];
+				instance.uvRect = r->getMaterial().uvRect;
+				instance.layer = (float)r->getMaterial().textureLayer;
+				instances[i] = instance;
+			}
+			instanceStream.flush();
+
+			bool cubeMapBound = false;
+			unsigned int end;
+			for (unsigned int start = 0; start < drawnCount; start = end)
+			{
+				const IRenderable* first = renderables[queue[start].index];
+				for (end = start + 1; end < drawnCount && sameBatch(first, renderables[queue[end].index]); end++);
+
+				//refractive draws all come last, the cube map is bound once for all of them
+				if (!cubeMapBound && SortKeys::getPass(queue[start].key) == SortKeys::PASS_REFRACTIVE)
 				{
-					glActiveTexture(GL_TEXTURE0);
-					glBindTexture(GL_TEXTURE_2D, determineTextureID(renderables[i]));
-					currentTextureID = determineTextureID(renderables[i]);
+					cubeMap.bindCubeMapTexture(1);
+					cubeMapBound = true;
 				}
 
-				phongShader.updateUniforms(
-					model.getMatrix() * renderables[i]->getModel(),
-					transformProjectionView * model.getMatrix() * renderables[i]->getModel(),
-					renderables[i]->getMaterial(),
-					cameraPosition);
-				if (renderables[i]->getMaterial().refractiveIndex >= 0) { glActiveTexture(GL_TEXTURE1); cubeMap.bindCubeMapTexture(); }
-				renderables[i]->draw();
-				if (renderables[i]->getMaterial().refractiveIndex >= 0) cubeMap.unbindCubeMapTexture();
+				//textures packed into one array sort together, the state cache drops all but the first bind of each
+				GLState::bindTexture(0, GL_TEXTURE_2D_ARRAY, first->getMaterial().getTextureID());
 
-				//glActiveTexture(GL_TEXTURE0);
+				phongShader.updateUniforms(first->getMaterial());
+				first->getMesh().drawInstanced(instanceStream.getBuffer(), instanceOffset + start * sizeof(InstanceData), end - start);
+				drawCallCount++;
 			}
-			glBindTexture(GL_TEXTURE_2D, 0);
+			instanceStream.endFrame();
 		}
-		phongShader.unbind();
 	}
 
 	ILayer* layerFactory(const vector<IRenderable*>& renderables)
@@ -2,7 +2,12 @@
 
 #include "ILayer.h"
 #include "Transform.h"
+#include "RenderQueue.h"
+#include "Mesh.h"
+#include "StreamBuffer.h"
+#include <gl/glew.h>
 #include <algorithm>
+#include <unordered_map>
 
 
 namespace ginkgo {
@@ -11,18 +16,46 @@ namespace ginkgo {
 	class IPhongShader;
 	class ICamera;
 	class ICubeMap;
+	class StaticGeometry;
 
 	class Layer : public ILayer
 	{
 	private:
+		//dense, removal swaps the last renderable into the hole
 		vector<IRenderable*> renderables;
+		std::unordered_map<int, unsigned int> slots; //UID -> index into renderables
+		//state version each slot's bounding sphere was built from, moves when the renderable gets another mesh
+		mutable vector<unsigned int> stateVersions;
+		vector<StaticGeometry*> bakes;
 		Transform model;
-		static const unsigned int NO_TEXTURE = 0; //must be equal than 0 -> created textures will never have an id of 0
 
-		static bool compareRenderables(IRenderable* r1, IRenderable* r2);
-		static unsigned int determineTextureID(IRenderable* r1);
+		//per frame culling scratch, structure of arrays padded to a multiple of 4
+		mutable vector<float> cullX, cullY, cullZ, cullRadius;
+		mutable vector<unsigned char> visible;
+		mutable vector<mat4> modelMatrices;
+		//transform version each slot's matrix and bounding sphere were last built from, 0 to rebuild
+		mutable vector<unsigned int> modelVersions;
+		//mesh data version each slot's bounding sphere was built from
+		mutable vector<unsigned int> meshVersions;
+		mutable unsigned int layerModelVersion;
+		mutable unsigned int drawnCount;
+		mutable unsigned int culledCount;
+		mutable unsigned int drawCallCount;
+
+		//visible renderables in draw order, their per instance data is written in the same order straight into the stream
+		mutable StreamBuffer instanceStream;
+		mutable RenderQueue queue;
+
+		void cull(const mat4& transformProjectionView) const;
+		void buildQueue(const vec3& cameraPosition) const;
+		int findSlot(int UID) const;
+		void invalidateModel(unsigned int slot) const;
+
+		static SortKey makeStateKey(const IRenderable* r);
+		static bool sameBatch(const IRenderable* r1, const IRenderable* r2);
 	public:
 		Layer(const vector<IRenderable*>& renderables);
+		~Layer();
 
 		unsigned int getSize() const { return renderables.size(); }
 
@@ -30,11 +63,16 @@ namespace ginkgo {
 		IRenderable* alterRenderable(int UID) const override;
 		const IRenderable* getRenderable(int UID) const override;
 		void removeRenderable(int UID) override;
+		unsigned int bakeStatic(const vector<int>& UIDs, float chunkSize) override;
 		
 		const mat4& getModel() const override;
 		ITransform& alterModel() override { return model; };
 
-		void draw(const mat4& transformProjectionView, const vec3& cameraPosition, const IPhongShader& phongShader, const ICubeMap& cubeMap) const override;
+		void draw(const mat4& projection, const mat4& view, const vec3& cameraPosition, const IPhongShader& phongShader, const ICubeMap& cubeMap) const override;
+
+		unsigned int getDrawnCount() const override { return drawnCount; }
+		unsigned int getCulledCount() const override { return culledCount; }
+		unsigned int getDrawCallCount() const override { return drawCallCount; }
 		//void drawButOne(unsigned int indexNOTDRAWN, const mat4& transformProjectionView, const vec3& cameraPosition, const PhongShader& phongShader, const CubeMap& cubeMap) const;
 		//void drawOne(unsigned int index, const mat4& transformProjectionView, const vec3& cameraPosition, const PhongShader& phongShader, const CubeMap& cubeMap) const;
 	};
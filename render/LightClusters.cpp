@@ -0,0 +1,220 @@
+#include <cmath>
+#include <cfloat>
+#include <algorithm>
+#include <iostream>
+
+#include "LightClusters.h"
+#include "GLState.h"
+
+namespace ginkgo {
+
+	namespace
+	{
+		//a 256th of full brightness, below what 8 bit output can show
+		const float LIGHT_CUTOFF = 1.0f / 256.0f;
+		//phongFragment.fs scales every point light by this
+		const float POINT_LIGHT_SCALE = 15.0f;
+	}
+
+	LightClusters::LightClusters()
+		: clusterScale(0.0f), maxLightsPerCluster(MAX_LIGHTS), reportedDroppedLights(false), reportedDroppedIndices(false)
+	{
+		GLint maxTextureBufferSize = 0;
+		glGetIntegerv(GL_MAX_TEXTURE_BUFFER_SIZE, &maxTextureBufferSize);
+		maxTexels = (unsigned int)glm::max(maxTextureBufferSize, 65536);
+		maxLights = glm::min(MAX_LIGHTS, maxTexels / 3);
+
+		GLuint* buffers[] = { &lightBuffer, &clusterBuffer, &indexBuffer };
+		GLuint* textures[] = { &lightTexture, &clusterTexture, &indexTexture };
+		const GLenum formats[] = { GL_RGBA32F, GL_RG32UI, GL_R16UI };
+		for (int i = 0; i < 3; i++)
+		{
+			glGenBuffers(1, buffers[i]);
+			upload(*buffers[i], 0, nullptr);
+			//the texture keeps pointing at the buffer through every reallocation
+			glGenTextures(1, textures[i]);
+			GLState::bindTexture(GL_TEXTURE_BUFFER, *textures[i]);
+			glTexBuffer(GL_TEXTURE_BUFFER, formats[i], *buffers[i]);
+		}
+		GLState::bindTexture(GL_TEXTURE_BUFFER, 0);
+	}
+
+	LightClusters::~LightClusters()
+	{
+		GLuint buffers[] = { lightBuffer, clusterBuffer, indexBuffer };
+		GLuint textures[] = { lightTexture, clusterTexture, indexTexture };
+		GLState::deleteTextures(3, textures);
+		GLState::deleteBuffers(3, buffers);
+	}
+
+	float LightClusters::computeRadius(const PointLight& light)
+	{
+		//specular uses the color without the intensity, so never count on less than the color itself
+		const vec4& color = light.base.color;
+		float brightness = POINT_LIGHT_SCALE * glm::max(color.r, glm::max(color.g, color.b)) * glm::max(light.base.intensity, 1.0f);
+		//attenuation at which brightness / attenuation drops to the cutoff
+		float c = light.attenuation.constant - brightness / LIGHT_CUTOFF;
+		float l = light.attenuation.linear;
+		float q = light.attenuation.quadratic;
+		if (q > 0)
+		{
+			float discriminant = l * l - 4.0f * q * c;
+			return (discriminant > 0) ? glm::max((-l + std::sqrt(discriminant)) / (2.0f * q), 0.0f) : 0.0f;
+		}
+		if (l > 0)
+		{
+			return glm::max(-c / l, 0.0f);
+		}
+		return (c < 0) ? FLT_MAX : 0.0f;
+	}
+
+	void LightClusters::upload(GLuint buffer, GLsizeiptr size, const void* data)
+	{
+		//never empty, some drivers won't sample a texture buffer without storage
+		static const unsigned int empty[4] = { 0, 0, 0, 0 };
+		GLState::bindBuffer(GL_TEXTURE_BUFFER, buffer);
+		if (size == 0)
+		{
+			glBufferData(GL_TEXTURE_BUFFER, sizeof(empty), empty, GL_STREAM_DRAW);
+		}
+		else
+		{
+			glBufferData(GL_TEXTURE_BUFFER, size, NULL, GL_STREAM_DRAW);
+			glBufferSubData(GL_TEXTURE_BUFFER, 0, size, data);
+		}
+	}
+
+	void LightClusters::build(const vector<std::pair<int, PointLight>>& lights, const mat4& projection, const mat4& view, GLint viewportWidth, GLint viewportHeight)
+	{
+		lightData.clear();
+		bounds.clear();
+		clusterData.assign(CLUSTER_COUNT * 2, 0);
+
+		//clip planes back out of a perspective matrix
+		float nearPlane = projection[3][2] / (projection[2][2] - 1.0f);
+		float farPlane = projection[3][2] / (projection[2][2] + 1.0f);
+		float logRatio = std::log(farPlane / nearPlane);
+		clusterScale = vec4(GRID_X / (float)viewportWidth, GRID_Y / (float)viewportHeight, GRID_Z / logRatio, -GRID_Z * std::log(nearPlane) / logRatio);
+
+		auto toSlice = [this](float depth)
+		{
+			return glm::clamp((int)std::floor(std::log(depth) * clusterScale.z + clusterScale.w), 0, GRID_Z - 1);
+		};
+		auto toTile = [](float ndc, int tiles)
+		{
+			return glm::clamp((int)std::floor((ndc * 0.5f + 0.5f) * tiles), 0, tiles - 1);
+		};
+
+		unsigned int count = glm::min((unsigned int)lights.size(), maxLights);
+		if (count < lights.size() && !reportedDroppedLights)
+		{
+			std::cout << "More than " << maxLights << " point lights, the rest are left out!" << std::endl;
+			reportedDroppedLights = true;
+		}
+		for (unsigned int i = 0; i < count; i++)
+		{
+			const PointLight& light = lights[i].second;
+			float radius = computeRadius(light);
+			vec4 center = view * vec4(light.position, 1.0f);
+			float depth = -center.z;
+			float zNear = glm::max(depth - radius, nearPlane);
+			float zFar = glm::min(depth + radius, farPlane);
+			if (radius <= 0 || zNear > zFar)
+			{
+				continue;
+			}
+
+			//x / depth over the light's view space box is extreme at its corners
+			vec2 ndcMin(FLT_MAX), ndcMax(-FLT_MAX);
+			for (int corner = 0; corner < 8; corner++)
+			{
+				float x = center.x + ((corner & 1) ? radius : -radius);
+				float y = center.y + ((corner & 2) ? radius : -radius);
+				float z = (corner & 4) ? zFar : zNear;
+				vec2 ndc(projection[0][0] * x / z, projection[1][1] * y / z);
+				ndcMin = glm::min(ndcMin, ndc);
+				ndcMax = glm::max(ndcMax, ndc);
+			}
+			if (ndcMax.x < -1.0f || ndcMin.x > 1.0f || ndcMax.y < -1.0f || ndcMin.y > 1.0f)
+			{
+				continue;
+			}
+
+			Bounds b = { toTile(ndcMin.x, GRID_X), toTile(ndcMax.x, GRID_X), toTile(ndcMin.y, GRID_Y), toTile(ndcMax.y, GRID_Y), toSlice(zNear), toSlice(zFar) };
+			bounds.push_back(b);
+			lightData.push_back(light.base.color);
+			lightData.push_back(vec4(light.position, light.base.intensity));
+			lightData.push_back(vec4(light.attenuation.constant, light.attenuation.linear, light.attenuation.quadratic, radius));
+
+			for (int z = b.z0; z <= b.z1; z++)
+				for (int y = b.y0; y <= b.y1; y++)
+					for (int x = b.x0; x <= b.x1; x++)
+						clusterData[((z * GRID_Y + y) * GRID_X + x) * 2 + 1]++;
+		}
+
+		//counts to offsets, the counts then fill back up as the indices go in
+		//past maxTexels indices the farthest slices get less room than they asked for
+		unsigned int offset = 0;
+		bool droppedIndices = false;
+		for (int c = 0; c < CLUSTER_COUNT; c++)
+		{
+			unsigned int wanted = glm::min(clusterData[c * 2 + 1], maxLightsPerCluster);
+			unsigned int room = glm::min(wanted, maxTexels - offset);
+			droppedIndices = droppedIndices || room < wanted;
+			clusterData[c * 2] = offset;
+			offset += room;
+			clusterData[c * 2 + 1] = 0;
+		}
+		indices.resize(offset);
+		if (droppedIndices && !reportedDroppedIndices)
+		{
+			std::cout << "Light clusters need more than " << maxTexels << " indices, distant clusters drop some lights!" << std::endl;
+			reportedDroppedIndices = true;
+		}
+		//a cluster's room is up to where the next one starts
+		auto capacity = [this, offset](int c)
+		{
+			return ((c + 1 < CLUSTER_COUNT) ? clusterData[(c + 1) * 2] : offset) - clusterData[c * 2];
+		};
+
+		//nearest first so a capped cluster drops its farthest lights
+		binOrder.resize(bounds.size());
+		for (unsigned int i = 0; i < bounds.size(); i++)
+		{
+			binOrder[i] = i;
+		}
+		if (maxLightsPerCluster < bounds.size())
+		{
+			std::stable_sort(binOrder.begin(), binOrder.end(), [this](unsigned int a, unsigned int b) { return bounds[a].z0 < bounds[b].z0; });
+		}
+		for (unsigned int n = 0; n < binOrder.size(); n++)
+		{
+			unsigned int i = binOrder[n];
+			const Bounds& b = bounds[i];
+			for (int z = b.z0; z <= b.z1; z++)
+				for (int y = b.y0; y <= b.y1; y++)
+					for (int x = b.x0; x <= b.x1; x++)
+					{
+						int c = (z * GRID_Y + y) * GRID_X + x;
+						if (clusterData[c * 2 + 1] < capacity(c))
+						{
+							indices[clusterData[c * 2] + clusterData[c * 2 + 1]++] = (unsigned short)i;
+						}
+					}
+		}
+
+		upload(lightBuffer, lightData.size() * sizeof(vec4), lightData.empty() ? nullptr : &lightData[0]);
+		upload(clusterBuffer, clusterData.size() * sizeof(unsigned int), &clusterData[0]);
+		upload(indexBuffer, indices.size() * sizeof(unsigned short), indices.empty() ? nullptr : &indices[0]);
+	}
+
+	void LightClusters::bind(GLuint firstUnit) const
+	{
+		const GLuint textures[] = { lightTexture, clusterTexture, indexTexture };
+		for (GLuint i = 0; i < 3; i++)
+		{
+			GLState::bindTexture(firstUnit + i, GL_TEXTURE_BUFFER, textures[i]);
+		}
+	}
+
+}
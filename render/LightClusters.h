@@ -0,0 +1,68 @@
+#pragma once
+
+#include "RenderResource.h"
+#include "LightStructs.h"
+#include <GL/glew.h>
+#include <utility>
+
+namespace ginkgo {
+
+	//clustered forward lighting: point lights binned each frame into a view space grid of screen tiles by exponential depth slices
+	//so each pixel only loops over the lights that reach its cluster
+	//everything goes to the fragment shader as texture buffers, GL 3.3 has no storage buffers
+	class LightClusters
+	{
+	private:
+		struct Bounds
+		{
+			int x0, x1, y0, y1, z0, z1; //inclusive cluster ranges
+		};
+
+		GLuint lightBuffer, lightTexture; //3 RGBA32F texels per light: color, position + intensity, attenuation + radius
+		GLuint clusterBuffer, clusterTexture; //RG32UI per cluster: first index, count
+		GLuint indexBuffer, indexTexture; //R16UI light indices, grouped by cluster
+
+		vector<vec4> lightData;
+		vector<unsigned int> clusterData;
+		vector<unsigned short> indices;
+		vector<Bounds> bounds;
+		vector<unsigned int> binOrder; //into bounds, nearest first
+		vec4 clusterScale;
+		unsigned int maxLightsPerCluster;
+		//GL_MAX_TEXTURE_BUFFER_SIZE, GL 3.3 only promises 65536 texels, which caps both the lights and the index total
+		unsigned int maxTexels;
+		unsigned int maxLights;
+		bool reportedDroppedLights;
+		bool reportedDroppedIndices;
+
+		static void upload(GLuint buffer, GLsizeiptr size, const void* data);
+	public:
+		//dependant on phongFragment.fs
+		static const int GRID_X = 16;
+		static const int GRID_Y = 9;
+		static const int GRID_Z = 24;
+		static const int CLUSTER_COUNT = GRID_X * GRID_Y * GRID_Z;
+		static const unsigned int MAX_LIGHTS = 65535; //indices are 16 bit, getMaxLights is the limit on this driver
+
+		LightClusters();
+		~LightClusters();
+
+		//projection must be a perspective one, viewport is what the layer draws into
+		void build(const vector<std::pair<int, PointLight>>& lights, const mat4& projection, const mat4& view, GLint viewportWidth, GLint viewportHeight);
+		//the light, cluster and index buffers on three consecutive units starting at firstUnit
+		void bind(GLuint firstUnit) const;
+
+		//clusters reached by more keep the nearest, by the slice the light starts in
+		void setMaxLightsPerCluster(unsigned int count) { maxLightsPerCluster = count; }
+
+		//pixels to tiles (xy), log view depth to slice (z scale, w bias)
+		const vec4& getClusterScale() const { return clusterScale; }
+		unsigned int getLightCount() const { return lightData.size() / 3; }
+		//lights past this are left out of build
+		unsigned int getMaxLights() const { return maxLights; }
+
+		//distance past which the light adds less than a 256th to a channel, matches the falloff in phongFragment.fs
+		static float computeRadius(const PointLight& light);
+	};
+
+}
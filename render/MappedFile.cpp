@@ -0,0 +1,112 @@
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <Windows.h>
+#else
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+#include "MappedFile.h"
+
+namespace ginkgo {
+
+#ifdef _WIN32
+	MappedFile::MappedFile(const string& path)
+		: file(INVALID_HANDLE_VALUE), mapping(NULL), view(nullptr), size(0)
+	{
+		file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+		if (file == INVALID_HANDLE_VALUE)
+		{
+			return;
+		}
+		LARGE_INTEGER fileSize;
+		if (!GetFileSizeEx(file, &fileSize) || fileSize.QuadPart == 0)
+		{
+			return;
+		}
+		size = fileSize.QuadPart;
+		mapping = CreateFileMappingA(file, NULL, PAGE_READONLY, 0, 0, NULL);
+		if (mapping == NULL)
+		{
+			return;
+		}
+		view = (const unsigned char*)MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+	}
+
+	MappedFile::~MappedFile()
+	{
+		if (view != nullptr) UnmapViewOfFile(view);
+		if (mapping != NULL) CloseHandle(mapping);
+		if (file != INVALID_HANDLE_VALUE) CloseHandle(file);
+	}
+
+	bool MappedFile::getTimestamp(const string& path, uint64_t& timestamp)
+	{
+		WIN32_FILE_ATTRIBUTE_DATA attributes;
+		if (!GetFileAttributesExA(path.c_str(), GetFileExInfoStandard, &attributes))
+		{
+			return false;
+		}
+		timestamp = ((uint64_t)attributes.ftLastWriteTime.dwHighDateTime << 32) | attributes.ftLastWriteTime.dwLowDateTime;
+		return true;
+	}
+#else
+	MappedFile::MappedFile(const string& path)
+		: file(-1), view(nullptr), size(0)
+	{
+		file = open(path.c_str(), O_RDONLY);
+		if (file == -1)
+		{
+			return;
+		}
+		struct stat attributes;
+		if (fstat(file, &attributes) != 0 || attributes.st_size == 0)
+		{
+			return;
+		}
+		size = attributes.st_size;
+		void* data = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, file, 0);
+		if (data != MAP_FAILED)
+		{
+			view = (const unsigned char*)data;
+		}
+	}
+
+	MappedFile::~MappedFile()
+	{
+		if (view != nullptr) munmap((void*)view, size);
+		if (file != -1) close(file);
+	}
+
+	bool MappedFile::getTimestamp(const string& path, uint64_t& timestamp)
+	{
+		struct stat attributes;
+		if (stat(path.c_str(), &attributes) != 0)
+		{
+			return false;
+		}
+		//nanoseconds, the caches only compare it for equality
+		timestamp = (uint64_t)attributes.st_mtim.tv_sec * 1000000000ull + attributes.st_mtim.tv_nsec;
+		return true;
+	}
+#endif
+
+	bool MappedFile::hashFile(const string& path, uint64_t& hash)
+	{
+		MappedFile source(path);
+		if (source.getData() == nullptr)
+		{
+			return false;
+		}
+		hash = 14695981039346656037ull;
+		for (uint64_t i = 0; i < source.getSize(); i++)
+		{
+			hash = (hash ^ source.getData()[i]) * 1099511628211ull;
+		}
+		return true;
+	}
+
+}
@@ -0,0 +1,38 @@
+#pragma once
+
+#include "RenderResource.h"
+#include <cstdint>
+
+namespace ginkgo {
+
+	//read only memory mapped view of a whole file, unmapped on destruction
+	//getData is null if the file is missing or empty
+	class MappedFile
+	{
+	private:
+#ifdef _WIN32
+		void* file;
+		void* mapping;
+#else
+		int file;
+#endif
+		const unsigned char* view;
+		uint64_t size;
+
+		MappedFile(const MappedFile&) = delete;
+		MappedFile& operator=(const MappedFile&) = delete;
+
+	public:
+		MappedFile(const string& path);
+		~MappedFile();
+
+		const unsigned char* getData() const { return view; }
+		uint64_t getSize() const { return (view != nullptr) ? size : 0; }
+
+		//last write time, for cache invalidation
+		static bool getTimestamp(const string& path, uint64_t& timestamp);
+		//FNV-1a over the file's bytes
+		static bool hashFile(const string& path, uint64_t& hash);
+	};
+
+}
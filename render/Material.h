@@ -1,14 +1,16 @@
 #pragma once
 
 #include "RenderResource.h"
+#include "Texture.h"
 
 namespace ginkgo {
 
-	struct Texture;
-
 	struct Material
 	{
-		const Texture* texture;
+		const Texture* texture; //change through setTexture, the layer and rect below come with it
+		//where the texture's image sits in its array, drawn per instance so any materials sharing the array batch together
+		GLint textureLayer;
+		vec4 uvRect; //offset xy, scale zw
 		vec4 color;
 		float specularIntensity;
 		float specularPower;
@@ -45,8 +47,50 @@ namespace ginkgo {
 		{ }
 
 		Material(float specularIntensity, float specularExponent, float refractiveIndex, float rIntensity, const vec4& color, const Texture* texture)
-			: specularIntensity(specularIntensity), specularPower(specularExponent), refractiveIndex(refractiveIndex), rIntensity(rIntensity), color(color), texture(texture)
-		{ }
+			: specularIntensity(specularIntensity), specularPower(specularExponent), refractiveIndex(refractiveIndex), rIntensity(rIntensity), color(color)
+		{
+			setTexture(texture);
+		}
+
+		void setTexture(const Texture* texture)
+		{
+			this->texture = texture;
+			textureLayer = (texture != nullptr) ? texture->layer : 0;
+			uvRect = (texture != nullptr) ? texture->uvRect : vec4(0.0f, 0.0f, 1.0f, 1.0f);
+		}
+
+		//folds the shader state into a small number, equivalent materials always hash the same
+		unsigned int hash() const
+		{
+			const float values[] = { color.r, color.g, color.b, color.a, specularIntensity, specularPower, refractiveIndex, rIntensity };
+			unsigned int h = 2166136261u;
+			const unsigned char* bytes = (const unsigned char*)values;
+			for (unsigned int i = 0; i < sizeof(values); i++)
+			{
+				h = (h ^ bytes[i]) * 16777619u;
+			}
+			return h;
+		}
+
+		//true if both would draw exactly the same (geometry using either can be merged under one material)
+		bool isEquivalent(const Material& other) const
+		{
+			return texture == other.texture && textureLayer == other.textureLayer && uvRect == other.uvRect && canBatchWith(other);
+		}
+
+		//true if both would set the same shader state and texture binding (can be drawn in one instanced batch)
+		bool canBatchWith(const Material& other) const
+		{
+			return getTextureID() == other.getTextureID() && color == other.color &&
+				specularIntensity == other.specularIntensity && specularPower == other.specularPower &&
+				refractiveIndex == other.refractiveIndex && rIntensity == other.rIntensity;
+		}
+
+		//0 without a texture, created textures never have an id of 0
+		GLuint getTextureID() const
+		{
+			return (texture != nullptr) ? texture->tid : 0;
+		}
 	};
 
 }
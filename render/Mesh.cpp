@@ -2,13 +2,21 @@
 
 #include "Mesh.h"
 #include "ObjLoader.h"
+#include "GLState.h"
+#include <glm/gtc/packing.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+#include <cstddef>
+#include <cstring>
+#include <iostream>
 
 namespace ginkgo {
 
-	Mesh::Mesh()
+	Mesh::Mesh(VertexFormat format)
+		: format(format), indexType(GL_UNSIGNED_INT), dequantization(1.0f), dataVersion(0)
 	{
 		size = 0;
-		data_size = 0;
+		vertexCount = 0;
+		bounds = computeBounds(nullptr, 0);
 		glGenVertexArrays(1, &VAO);
 		glGenBuffers(1, &VBO);
 		glGenBuffers(1, &EBO);
@@ -16,12 +24,12 @@ namespace ginkgo {
 
 	Mesh::~Mesh()
 	{
-		glDeleteBuffers(1, &EBO);
-		glDeleteBuffers(1, &VBO);
-		glDeleteVertexArrays(1, &VAO);
+		GLState::deleteBuffers(1, &EBO);
+		GLState::deleteBuffers(1, &VBO);
+		GLState::deleteVertexArrays(1, &VAO);
 	}
 
-	void Mesh::addData(const vector<vec3>& positions, const vector<GLuint>& indices, const vector<vec2>& uvs, const vector<vec3>& normalsM)
+	vector<GLfloat> Mesh::interleave(const vector<vec3>& positions, const vector<GLuint>& indices, const vector<vec2>& uvs, const vector<vec3>& normalsM)
 	{
 		//Generating Normals
 		vector<vec3> normals = normalsM;
@@ -51,8 +59,7 @@ namespace ginkgo {
 		}
 
 		//Loading Data
-		data_size = positions.size() * 8;
-		GLfloat* data = new GLfloat[data_size];
+		vector<GLfloat> data(positions.size() * VERTEX_STRIDE);
 
 		if (positions.size() != uvs.size() || positions.size() != normals.size())
 		{
@@ -69,54 +76,284 @@ namespace ginkgo {
 			}
 
 		}
+		else
+		{
+			for (GLuint i = 0; i < positions.size(); i++)
+			{
+				data[i * 8 + 0] = positions[i].x;
+				data[i * 8 + 1] = positions[i].y;
+				data[i * 8 + 2] = positions[i].z;
+				data[i * 8 + 3] = uvs[i].x;
+				data[i * 8 + 4] = uvs[i].y;
+				data[i * 8 + 5] = normals[i].x;
+				data[i * 8 + 6] = normals[i].y;
+				data[i * 8 + 7] = normals[i].z;
+			}
+		}
+
+		return data;
+	}
+
+	void Mesh::addData(const vector<vec3>& positions, const vector<GLuint>& indices, const vector<vec2>& uvs, const vector<vec3>& normals)
+	{
+		vector<GLfloat> data = interleave(positions, indices, uvs, normals);
+		addInterleavedData(data.empty() ? nullptr : &data[0], positions.size(), indices.empty() ? nullptr : &indices[0], indices.size());
+	}
+
+	MeshBounds Mesh::computeBounds(const GLfloat* vertices, GLuint vertexCount)
+	{
+		MeshBounds bounds = { vec3(0.0f), vec3(0.0f), vec3(0.0f), 0.0f };
+		if (vertexCount == 0)
+		{
+			return bounds;
+		}
+
+		bounds.min = bounds.max = vec3(vertices[0], vertices[1], vertices[2]);
+		for (GLuint i = 1; i < vertexCount; i++)
+		{
+			const GLfloat* p = vertices + i * VERTEX_STRIDE;
+			bounds.min = glm::min(bounds.min, vec3(p[0], p[1], p[2]));
+			bounds.max = glm::max(bounds.max, vec3(p[0], p[1], p[2]));
+		}
+		bounds.sphereCenter = (bounds.min + bounds.max) * 0.5f;
+		for (GLuint i = 0; i < vertexCount; i++)
+		{
+			const GLfloat* p = vertices + i * VERTEX_STRIDE;
+			bounds.sphereRadius = glm::max(bounds.sphereRadius, glm::length(vec3(p[0], p[1], p[2]) - bounds.sphereCenter));
+		}
+		return bounds;
+	}
+
+	void Mesh::addInterleavedData(const GLfloat* vertices, GLuint vertexCount, const GLuint* indices, GLuint indexCount)
+	{
+		addInterleavedData(vertices, vertexCount, indices, indexCount, computeBounds(vertices, vertexCount));
+	}
+
+	void Mesh::addInterleavedData(const GLfloat* vertices, GLuint vertexCount, const GLuint* indices, GLuint indexCount, const MeshBounds& bounds)
+	{
+		PackedMesh packed;
+		pack(format, vertices, vertexCount, indices, indexCount, bounds, packed);
+		addPackedData(packed);
+	}
+
+	void Mesh::pack(VertexFormat format, const GLfloat* vertices, GLuint vertexCount, const GLuint* indices, GLuint indexCount, const MeshBounds& bounds, PackedMesh& out)
+	{
+		out.format = format;
+		out.vertexCount = vertexCount;
+		out.indexCount = indexCount;
+		out.bounds = bounds;
+
+		//quantized positions are stored in [-1, 1] across the bounds, one scale for all axes so normals keep their direction
+		vec3 quantizationOffset(0.0f);
+		float quantizationScale = 1.0f;
+		if (format != VERTEX_FLOAT)
+		{
+			vec3 halfExtent = (bounds.max - bounds.min) * 0.5f;
+			quantizationOffset = (bounds.min + bounds.max) * 0.5f;
+			quantizationScale = glm::max(glm::max(halfExtent.x, halfExtent.y), glm::max(halfExtent.z, 1e-6f));
+		}
+		out.dequantization = glm::translate(mat4(1.0f), quantizationOffset) * glm::scale(mat4(1.0f), vec3(quantizationScale));
+
+		GLsizei stride = getVertexSize(format);
+		out.vertices.resize(vertexCount * stride);
+		if (format == VERTEX_FLOAT)
+		{
+			if (vertexCount > 0)
+			{
+				memcpy(&out.vertices[0], vertices, out.vertices.size());
+			}
+		}
+		else
+		{
+			for (GLuint i = 0; i < vertexCount; i++)
+			{
+				const GLfloat* v = vertices + i * VERTEX_STRIDE;
+				PackedVertex& p = *(PackedVertex*)&out.vertices[i * stride];
+				vec3 position = (vec3(v[0], v[1], v[2]) - quantizationOffset) / quantizationScale;
+				for (int c = 0; c < 3; c++)
+				{
+					p.position[c] = (format == VERTEX_HALF) ? glm::packHalf1x16(position[c]) : glm::packSnorm1x16(position[c]);
+				}
+				p.position[3] = 0;
+				p.normal = glm::packSnorm3x10_1x2(vec4(v[5], v[6], v[7], 0.0f));
+				p.uv[0] = glm::packHalf1x16(v[3]);
+				p.uv[1] = glm::packHalf1x16(v[4]);
+			}
+		}
+
+		//16 bit indices whenever they fit
+		if (vertexCount <= 65535)
+		{
+			out.indexType = GL_UNSIGNED_SHORT;
+			out.indices.resize(indexCount * sizeof(GLushort));
+			GLushort* shortIndices = (GLushort*)out.indices.data();
+			for (GLuint i = 0; i < indexCount; i++)
+			{
+				shortIndices[i] = (GLushort)indices[i];
+			}
+		}
+		else
+		{
+			out.indexType = GL_UNSIGNED_INT;
+			out.indices.resize(indexCount * sizeof(GLuint));
+			if (indexCount > 0)
+			{
+				memcpy(&out.indices[0], indices, out.indices.size());
+			}
+		}
+	}
 
-		for (GLuint i = 0; i < positions.size(); i++)
+	bool Mesh::addPackedData(const PackedMesh& packed)
+	{
+		//the blocks are quantized already, unpacking them to pack again would lose precision, so the caller repacks from source
+		if (packed.format != format)
 		{
-			data[i * 8 + 0] = positions[i].x;
-			data[i * 8 + 1] = positions[i].y;
-			data[i * 8 + 2] = positions[i].z;
-			data[i * 8 + 3] = uvs[i].x;
-			data[i * 8 + 4] = uvs[i].y;
-			data[i * 8 + 5] = normals[i].x;
-			data[i * 8 + 6] = normals[i].y;
-			data[i * 8 + 7] = normals[i].z;
+			std::cout << "Packed mesh is in vertex format " << packed.format << " but the mesh wants " << format << ", nothing uploaded!" << std::endl;
+			return false;
 		}
+		addPackedData(packed.vertices.empty() ? nullptr : &packed.vertices[0], packed.vertexCount,
+			packed.indices.empty() ? nullptr : &packed.indices[0], packed.indexCount, packed.indexType, packed.dequantization, packed.bounds);
+		return true;
+	}
 
-		//Binding Data
-		size = indices.size();
+	void Mesh::addPackedData(const void* vertices, GLuint vertexCount, const void* indices, GLuint indexCount, GLenum indexType, const mat4& dequantization, const MeshBounds& bounds)
+	{
+		this->bounds = bounds;
+		this->vertexCount = vertexCount;
+		this->size = indexCount;
+		this->indexType = indexType;
+		this->dequantization = dequantization;
+		dataVersion++;
+
+		GLsizei stride = getVertexSize(format);
+		GLsizeiptr indexSize = indexCount * ((indexType == GL_UNSIGNED_SHORT) ? sizeof(GLushort) : sizeof(GLuint));
 
-		glBindVertexArray(VAO);
-		glBindBuffer(GL_ARRAY_BUFFER, VBO);
-		glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, EBO);
+		GLState::bindVertexArray(VAO);
+		GLState::bindBuffer(GL_ARRAY_BUFFER, VBO);
+		GLState::bindBuffer(GL_ELEMENT_ARRAY_BUFFER, EBO);
 
-		glBufferData(GL_ARRAY_BUFFER, data_size * sizeof(GLfloat), data, GL_STATIC_DRAW); //&data[0]
-		glBufferData(GL_ELEMENT_ARRAY_BUFFER, indices.size() * sizeof(GLuint), &indices[0], GL_STATIC_DRAW); //TODO: indices //? too
+		glBufferData(GL_ARRAY_BUFFER, vertexCount * stride, vertices, GL_STATIC_DRAW);
+		glBufferData(GL_ELEMENT_ARRAY_BUFFER, indexSize, indices, GL_STATIC_DRAW);
 
+		//attribute pointers are VAO state, draw and drawInstanced pick them up from the bind
 		glEnableVertexAttribArray(0);
 		glEnableVertexAttribArray(1);
 		glEnableVertexAttribArray(2);
-		glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(GLfloat), 0);
-		glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, 8 * sizeof(GLfloat), (GLvoid*)(3 * sizeof(GLfloat)));
-		glVertexAttribPointer(2, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(GLfloat), (GLvoid*)(5 * sizeof(GLfloat)));
+		switch (format)
+		{
+		case VERTEX_FLOAT:
+			glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, stride, 0);
+			glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, stride, (GLvoid*)(3 * sizeof(GLfloat)));
+			glVertexAttribPointer(2, 3, GL_FLOAT, GL_FALSE, stride, (GLvoid*)(5 * sizeof(GLfloat)));
+			break;
+		case VERTEX_HALF:
+		case VERTEX_SNORM16:
+			if (format == VERTEX_HALF)
+				glVertexAttribPointer(0, 3, GL_HALF_FLOAT, GL_FALSE, stride, (GLvoid*)offsetof(PackedVertex, position));
+			else
+				glVertexAttribPointer(0, 3, GL_SHORT, GL_TRUE, stride, (GLvoid*)offsetof(PackedVertex, position));
+			glVertexAttribPointer(1, 2, GL_HALF_FLOAT, GL_FALSE, stride, (GLvoid*)offsetof(PackedVertex, uv));
+			glVertexAttribPointer(2, 4, GL_INT_2_10_10_10_REV, GL_TRUE, stride, (GLvoid*)offsetof(PackedVertex, normal));
+			break;
+		}
+
+		//the element buffer stays attached, unbinding it here would take it off the vertex array
+		GLState::bindBuffer(GL_ARRAY_BUFFER, 0);
+		GLState::bindVertexArray(0);
+	}
+
+	GLsizei Mesh::getVertexSize(VertexFormat format)
+	{
+		return (format == VERTEX_FLOAT) ? VERTEX_STRIDE * sizeof(GLfloat) : sizeof(PackedVertex);
+	}
+
+	void Mesh::readBack(vector<GLfloat>& vertices, vector<GLuint>& indices) const
+	{
+		vertices.resize(vertexCount * VERTEX_STRIDE);
+		indices.resize(size);
+		if (size == 0)
+		{
+			return;
+		}
+
+		GLsizei stride = getVertexSize(format);
+		vector<unsigned char> raw(vertexCount * stride);
+		GLState::bindBuffer(GL_ARRAY_BUFFER, VBO);
+		glGetBufferSubData(GL_ARRAY_BUFFER, 0, raw.size(), &raw[0]);
+		GLState::bindBuffer(GL_ARRAY_BUFFER, 0);
+
+		if (format == VERTEX_FLOAT)
+		{
+			memcpy(&vertices[0], &raw[0], raw.size());
+		}
+		else
+		{
+			for (GLuint i = 0; i < vertexCount; i++)
+			{
+				const PackedVertex& in = *(const PackedVertex*)&raw[i * stride];
+				vec3 position;
+				for (int c = 0; c < 3; c++)
+				{
+					position[c] = (format == VERTEX_HALF) ? glm::unpackHalf1x16(in.position[c]) : glm::unpackSnorm1x16(in.position[c]);
+				}
+				position = vec3(dequantization * vec4(position, 1.0f));
+				vec4 normal = glm::unpackSnorm3x10_1x2(in.normal);
 
-		glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
-		glBindBuffer(GL_ARRAY_BUFFER, 0);
-		glBindVertexArray(0);
+				GLfloat* out = &vertices[i * VERTEX_STRIDE];
+				out[0] = position.x;
+				out[1] = position.y;
+				out[2] = position.z;
+				out[3] = glm::unpackHalf1x16(in.uv[0]);
+				out[4] = glm::unpackHalf1x16(in.uv[1]);
+				out[5] = normal.x;
+				out[6] = normal.y;
+				out[7] = normal.z;
+			}
+		}
 
-		delete[] data;
+		//the element buffer binding is VAO state, so go through the array buffer target instead
+		GLState::bindBuffer(GL_ARRAY_BUFFER, EBO);
+		if (indexType == GL_UNSIGNED_SHORT)
+		{
+			vector<GLushort> shortIndices(size);
+			glGetBufferSubData(GL_ARRAY_BUFFER, 0, size * sizeof(GLushort), &shortIndices[0]);
+			indices.assign(shortIndices.begin(), shortIndices.end());
+		}
+		else
+		{
+			glGetBufferSubData(GL_ARRAY_BUFFER, 0, size * sizeof(GLuint), &indices[0]);
+		}
+		GLState::bindBuffer(GL_ARRAY_BUFFER, 0);
 	}
 
 	void Mesh::draw() const
 	{
-		glBindVertexArray(VAO);
-		glBindBuffer(GL_ARRAY_BUFFER, VBO);
-		glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, EBO);
+		//the element buffer and attribute pointers came with the vertex array, nothing else to bind
+		GLState::bindVertexArray(VAO);
+		glDrawElements(GL_TRIANGLES, size, indexType, 0);
+	}
+
+	void Mesh::drawInstanced(GLuint instanceVBO, GLintptr offset, GLsizei count) const
+	{
+		GLState::bindVertexArray(VAO);
+		GLState::bindBuffer(GL_ARRAY_BUFFER, instanceVBO);
 
-		glDrawElements(GL_TRIANGLES, size, GL_UNSIGNED_INT, 0);
+		//a mat4 attribute is four vec4 columns
+		for (GLuint column = 0; column < 4; column++)
+		{
+			GLuint attribute = INSTANCE_MODEL_ATTRIBUTE + column;
+			glEnableVertexAttribArray(attribute);
+			glVertexAttribPointer(attribute, 4, GL_FLOAT, GL_FALSE, sizeof(InstanceData), (GLvoid*)(offset + offsetof(InstanceData, model) + column * sizeof(vec4)));
+			glVertexAttribDivisor(attribute, 1);
+		}
+		glEnableVertexAttribArray(INSTANCE_TEXTURE_ATTRIBUTE);
+		glVertexAttribPointer(INSTANCE_TEXTURE_ATTRIBUTE, 4, GL_FLOAT, GL_FALSE, sizeof(InstanceData), (GLvoid*)(offset + offsetof(InstanceData, uvRect)));
+		glVertexAttribDivisor(INSTANCE_TEXTURE_ATTRIBUTE, 1);
+		glEnableVertexAttribArray(INSTANCE_TEXTURE_ATTRIBUTE + 1);
+		glVertexAttribPointer(INSTANCE_TEXTURE_ATTRIBUTE + 1, 1, GL_FLOAT, GL_FALSE, sizeof(InstanceData), (GLvoid*)(offset + offsetof(InstanceData, layer)));
+		glVertexAttribDivisor(INSTANCE_TEXTURE_ATTRIBUTE + 1, 1);
 
-		glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
-		glBindBuffer(GL_ARRAY_BUFFER, 0);
-		glBindVertexArray(0);
+		glDrawElementsInstanced(GL_TRIANGLES, size, indexType, 0, count);
 	}
 
 }
\ No newline at end of file
@@ -6,18 +6,116 @@
 
 namespace ginkgo 
 {
+	enum VertexFormat
+	{
+		VERTEX_FLOAT,	//32 bytes: float position, uv and normal
+		VERTEX_HALF,	//16 bytes: half float position across the bounds, half float uv, 2_10_10_10 normal
+		VERTEX_SNORM16,	//16 bytes: normalized int16 position across the bounds, half float uv, 2_10_10_10 normal
+	};
+
+	//local space, box plus a sphere around the box center that is tight enough for culling
+	struct MeshBounds
+	{
+		vec3 min;
+		vec3 max;
+		vec3 sphereCenter;
+		float sphereRadius;
+	};
+
+	//a mesh's buffers exactly as they go to GL, what the mesh cache stores and the asset loader hands over
+	struct PackedMesh
+	{
+		VertexFormat format;
+		vector<unsigned char> vertices;
+		vector<unsigned char> indices;
+		GLuint vertexCount;
+		GLuint indexCount;
+		GLenum indexType; //GL_UNSIGNED_SHORT when every index fits
+		mat4 dequantization; //quantized position -> local space, identity for VERTEX_FLOAT
+		MeshBounds bounds;
+	};
+
+	//one per instance in the buffer drawInstanced reads, dependant on phongVertex.vs
+	struct InstanceData
+	{
+		mat4 model;
+		vec4 uvRect; //where the material's image sits in its texture array, offset xy, scale zw
+		float layer;
+		float padding[3];
+	};
+
 	class Mesh
 	{
 	private:
+		//gpu layout of VERTEX_HALF and VERTEX_SNORM16
+		struct PackedVertex
+		{
+			unsigned short position[4]; //w unused, keeps the normal 4 byte aligned
+			unsigned int normal;
+			unsigned short uv[2];
+		};
+
 		GLuint VAO;
 		GLuint VBO;
 		GLuint EBO;
 		GLuint size;
-		GLuint data_size;
+		GLuint vertexCount;
+		VertexFormat format;
+		GLenum indexType; //GL_UNSIGNED_SHORT when every index fits
+		mat4 dequantization; //quantized position -> local space, identity for VERTEX_FLOAT
+
+		//filled in by addData
+		MeshBounds bounds;
+		//bumped by every upload, an async mesh swaps its placeholder's data without anything else changing
+		unsigned int dataVersion;
+
 	public:
-		Mesh();
+		Mesh(VertexFormat format = VERTEX_FLOAT);
 		~Mesh();
+		//the interleaved float layout below, generating smooth normals if none are given
+		static vector<GLfloat> interleave(const vector<vec3>& positions, const vector<GLuint>& indices, const vector<vec2>& uvs, const vector<vec3>& normals = vector<vec3>());
 		void addData(const vector<vec3>& positions, const vector<GLuint>& indices, const vector<vec2>& uvs, const vector<vec3>& normals = vector<vec3>());
+		//vertices already in the layout below (position, uv, normal), computes bounds and uploads in this mesh's format
+		void addInterleavedData(const GLfloat* vertices, GLuint vertexCount, const GLuint* indices, GLuint indexCount);
+		//same, with bounds that were computed ahead of time (mesh cache, asset loader)
+		void addInterleavedData(const GLfloat* vertices, GLuint vertexCount, const GLuint* indices, GLuint indexCount, const MeshBounds& bounds);
+		//blocks already in GPU layout for format, as returned by pack, uploaded as they are
+		void addPackedData(const void* vertices, GLuint vertexCount, const void* indices, GLuint indexCount, GLenum indexType, const mat4& dequantization, const MeshBounds& bounds);
+		//false, and nothing uploaded, if packed is in another format than this mesh
+		bool addPackedData(const PackedMesh& packed);
+		//no GL, safe off the render thread
+		static MeshBounds computeBounds(const GLfloat* vertices, GLuint vertexCount);
+		//the interleaved float layout below quantized into format, with 16 bit indices when they fit
+		static void pack(VertexFormat format, const GLfloat* vertices, GLuint vertexCount, const GLuint* indices, GLuint indexCount, const MeshBounds& bounds, PackedMesh& out);
+		//copies the uploaded buffers back out of GL in the interleaved float layout, for load time tools like static baking
+		void readBack(vector<GLfloat>& vertices, vector<GLuint>& indices) const;
 		virtual void draw() const;
+		//draws count copies, reading one InstanceData per instance from instanceVBO starting at offset (bytes)
+		void drawInstanced(GLuint instanceVBO, GLintptr offset, GLsizei count) const;
+
+		//floats per vertex: position (3), uv (2), normal (3)
+		static const GLuint VERTEX_STRIDE = 8;
+		//first of the four attribute locations the instance model matrix takes, dependant on phongVertex.vs
+		static const GLuint INSTANCE_MODEL_ATTRIBUTE = 3;
+		//uv rect, then the layer
+		static const GLuint INSTANCE_TEXTURE_ATTRIBUTE = 7;
+
+		//unique among live meshes
+		GLuint getID() const { return VAO; }
+
+		VertexFormat getFormat() const { return format; }
+		//bytes per vertex on the GPU
+		static GLsizei getVertexSize(VertexFormat format);
+		bool isQuantized() const { return format != VERTEX_FLOAT; }
+		//apply before the model matrix when positions are quantized
+		const mat4& getDequantization() const { return dequantization; }
+
+		const MeshBounds& getBounds() const { return bounds; }
+		const vec3& getBoundsMin() const { return bounds.min; }
+		const vec3& getBoundsMax() const { return bounds.max; }
+		const vec3& getBoundingSphereCenter() const { return bounds.sphereCenter; }
+		float getBoundingSphereRadius() const { return bounds.sphereRadius; }
+		//changes whenever the data and bounds are replaced
+		unsigned int getDataVersion() const { return dataVersion; }
 	};
 }
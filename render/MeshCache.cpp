@@ -0,0 +1,191 @@
+#include <fstream>
+#include <cstring>
+#include <cstddef>
+#include <atomic>
+#include <iostream>
+
+#include "MeshCache.h"
+#include "Mesh.h"
+#include "MappedFile.h"
+
+namespace ginkgo {
+
+	namespace
+	{
+		//the loader threads save too
+		std::atomic<bool> reportedSaveFailure(false);
+
+		bool saveFailed(const string& cachePath)
+		{
+			if (!reportedSaveFailure.exchange(true))
+			{
+				std::cout << "Failed to write mesh cache " << cachePath << ", meshes are imported from source on every load!" << std::endl;
+			}
+			return false;
+		}
+
+		//the source was touched but hashes the same, stamp the entry so later loads skip the hash
+		//only once the mapping is closed, windows refuses writes to a mapped file
+		void refreshTimestamp(const string& cachePath, uint64_t timestamp)
+		{
+			std::fstream file(cachePath, std::ios::in | std::ios::out | std::ios::binary);
+			file.seekp(offsetof(MeshCacheHeader, sourceTimestamp));
+			file.write((const char*)&timestamp, sizeof(timestamp));
+			if (!file)
+			{
+				saveFailed(cachePath);
+			}
+		}
+	}
+
+	string MeshCache::getCachePath(const string& sourcePath, VertexFormat format)
+	{
+		static const char* const suffixes[] = { ".float.gmesh", ".half.gmesh", ".snorm16.gmesh" };
+		return sourcePath + suffixes[format];
+	}
+
+	uint64_t MeshCache::getIndexSize(const MeshCacheHeader& header)
+	{
+		return (header.indexType == GL_UNSIGNED_SHORT) ? sizeof(GLushort) : sizeof(GLuint);
+	}
+
+	const MeshCacheHeader* MeshCache::validate(const unsigned char* data, uint64_t size, const string& sourcePath, VertexFormat format, uint64_t& timestamp)
+	{
+		if (size < sizeof(MeshCacheHeader))
+		{
+			return nullptr;
+		}
+
+		const MeshCacheHeader& header = *(const MeshCacheHeader*)data;
+		if (header.magic != MeshCacheHeader::MAGIC || header.version != MeshCacheHeader::VERSION || header.format != (uint32_t)format)
+		{
+			return nullptr;
+		}
+		if (header.indexType != GL_UNSIGNED_SHORT && header.indexType != GL_UNSIGNED_INT)
+		{
+			return nullptr;
+		}
+		uint64_t vertexBytes = (uint64_t)header.vertexCount * Mesh::getVertexSize(format);
+		uint64_t indexBytes = (uint64_t)header.indexCount * getIndexSize(header);
+		if (size != sizeof(MeshCacheHeader) + vertexBytes + indexBytes)
+		{
+			return nullptr;
+		}
+
+		//a touched but unchanged source (checkout, copy) still matches on the hash
+		uint64_t hash;
+		if (!MappedFile::getTimestamp(sourcePath, timestamp))
+		{
+			return nullptr;
+		}
+		if (timestamp != header.sourceTimestamp && (!MappedFile::hashFile(sourcePath, hash) || hash != header.sourceHash))
+		{
+			return nullptr;
+		}
+		return &header;
+	}
+
+	MeshBounds MeshCache::getBounds(const MeshCacheHeader& header)
+	{
+		MeshBounds bounds;
+		bounds.min = vec3(header.boundsMin[0], header.boundsMin[1], header.boundsMin[2]);
+		bounds.max = vec3(header.boundsMax[0], header.boundsMax[1], header.boundsMax[2]);
+		bounds.sphereCenter = vec3(header.sphereCenter[0], header.sphereCenter[1], header.sphereCenter[2]);
+		bounds.sphereRadius = header.sphereRadius;
+		return bounds;
+	}
+
+	mat4 MeshCache::getDequantization(const MeshCacheHeader& header)
+	{
+		mat4 m;
+		memcpy(&m[0][0], header.dequantization, sizeof(header.dequantization));
+		return m;
+	}
+
+	bool MeshCache::load(const string& cachePath, const string& sourcePath, Mesh& mesh)
+	{
+		uint64_t timestamp;
+		bool touched;
+		{
+			MappedFile cache(cachePath);
+			const MeshCacheHeader* header = validate(cache.getData(), cache.getSize(), sourcePath, mesh.getFormat(), timestamp);
+			if (header == nullptr)
+			{
+				return false;
+			}
+
+			const unsigned char* vertices = cache.getData() + sizeof(MeshCacheHeader);
+			const unsigned char* indices = vertices + (uint64_t)header->vertexCount * Mesh::getVertexSize(mesh.getFormat());
+			mesh.addPackedData(vertices, header->vertexCount, indices, header->indexCount, header->indexType, getDequantization(*header), getBounds(*header));
+			touched = timestamp != header->sourceTimestamp;
+		}
+		if (touched)
+		{
+			refreshTimestamp(cachePath, timestamp);
+		}
+		return true;
+	}
+
+	bool MeshCache::read(const string& cachePath, const string& sourcePath, VertexFormat format, PackedMesh& mesh)
+	{
+		uint64_t timestamp;
+		bool touched;
+		{
+			MappedFile cache(cachePath);
+			const MeshCacheHeader* header = validate(cache.getData(), cache.getSize(), sourcePath, format, timestamp);
+			if (header == nullptr)
+			{
+				return false;
+			}
+
+			const unsigned char* vertices = cache.getData() + sizeof(MeshCacheHeader);
+			const unsigned char* indices = vertices + (uint64_t)header->vertexCount * Mesh::getVertexSize(format);
+			const unsigned char* end = indices + header->indexCount * getIndexSize(*header);
+			mesh.format = format;
+			mesh.vertexCount = header->vertexCount;
+			mesh.indexCount = header->indexCount;
+			mesh.indexType = header->indexType;
+			mesh.vertices.assign(vertices, indices);
+			mesh.indices.assign(indices, end);
+			mesh.dequantization = getDequantization(*header);
+			mesh.bounds = getBounds(*header);
+			touched = timestamp != header->sourceTimestamp;
+		}
+		if (touched)
+		{
+			refreshTimestamp(cachePath, timestamp);
+		}
+		return true;
+	}
+
+	bool MeshCache::save(const string& cachePath, const string& sourcePath, const PackedMesh& mesh)
+	{
+		MeshCacheHeader header;
+		header.magic = MeshCacheHeader::MAGIC;
+		header.version = MeshCacheHeader::VERSION;
+		if (!MappedFile::getTimestamp(sourcePath, header.sourceTimestamp) || !MappedFile::hashFile(sourcePath, header.sourceHash))
+		{
+			return saveFailed(cachePath);
+		}
+
+		header.format = mesh.format;
+		header.indexType = mesh.indexType;
+		header.vertexCount = mesh.vertexCount;
+		header.indexCount = mesh.indexCount;
+		memcpy(header.dequantization, &mesh.dequantization[0][0], sizeof(header.dequantization));
+		for (int i = 0; i < 3; i++)
+		{
+			header.boundsMin[i] = mesh.bounds.min[i];
+			header.boundsMax[i] = mesh.bounds.max[i];
+			header.sphereCenter[i] = mesh.bounds.sphereCenter[i];
+		}
+		header.sphereRadius = mesh.bounds.sphereRadius;
+
+		std::ofstream out(cachePath, std::ios::binary | std::ios::trunc);
+		out.write((const char*)&header, sizeof(header));
+		if (!mesh.vertices.empty()) out.write((const char*)&mesh.vertices[0], mesh.vertices.size());
+		if (!mesh.indices.empty()) out.write((const char*)&mesh.indices[0], mesh.indices.size());
+		return out.good() || saveFailed(cachePath);
+	}
+
+}
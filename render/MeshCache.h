@@ -0,0 +1,54 @@
+#pragma once
+
+#include "RenderResource.h"
+#include "Mesh.h"
+#include <GL/glew.h>
+#include <cstdint>
+
+namespace ginkgo {
+
+	//binary copy of a loaded mesh, vertex and index blocks already in the GPU layout of one VertexFormat
+	//file layout: MeshCacheHeader | vertices (vertexCount * Mesh::getVertexSize(format)) | indices (indexCount of indexType)
+	struct MeshCacheHeader
+	{
+		static const uint32_t MAGIC = 0x48534D47; //"GMSH"
+		static const uint32_t VERSION = 3; //bump whenever the layout or a vertex format changes
+
+		uint32_t magic;
+		uint32_t version;
+		uint64_t sourceTimestamp; //last write time of the source file
+		uint64_t sourceHash; //FNV-1a of the source file's bytes
+		uint32_t format; //VertexFormat
+		uint32_t indexType; //GL_UNSIGNED_SHORT or GL_UNSIGNED_INT
+		uint32_t vertexCount;
+		uint32_t indexCount;
+		float dequantization[16]; //column major
+		float boundsMin[3];
+		float boundsMax[3];
+		float sphereCenter[3];
+		float sphereRadius;
+	};
+
+	class MeshCache
+	{
+	public:
+		//cache file that belongs to an .obj, one per format
+		static string getCachePath(const string& sourcePath, VertexFormat format);
+
+		//maps the cache file and uploads straight from the mapping
+		//false if it is missing, from another version or format, or the source has changed since it was written
+		static bool load(const string& cachePath, const string& sourcePath, Mesh& mesh);
+		//same checks, copies out of the mapping instead of uploading, no GL so safe on a worker thread
+		static bool read(const string& cachePath, const string& sourcePath, VertexFormat format, PackedMesh& mesh);
+		//false on io failure, only the first one is logged
+		static bool save(const string& cachePath, const string& sourcePath, const PackedMesh& mesh);
+
+	private:
+		//timestamp gets the source's current one, it differs from the header's when only the hash matched
+		static const MeshCacheHeader* validate(const unsigned char* data, uint64_t size, const string& sourcePath, VertexFormat format, uint64_t& timestamp);
+		static MeshBounds getBounds(const MeshCacheHeader& header);
+		static mat4 getDequantization(const MeshCacheHeader& header);
+		static uint64_t getIndexSize(const MeshCacheHeader& header);
+	};
+
+}
@@ -0,0 +1,317 @@
+#include "MeshOptimizer.h"
+
+#include <unordered_map>
+#include <cstring>
+#include <cmath>
+
+namespace ginkgo {
+
+	namespace
+	{
+		struct VertexKey
+		{
+			float values[8];
+
+			bool operator==(const VertexKey& other) const
+			{
+				for (int i = 0; i < 8; i++)
+				{
+					if (values[i] != other.values[i]) return false;
+				}
+				return true;
+			}
+		};
+
+		struct VertexKeyHash
+		{
+			size_t operator()(const VertexKey& key) const
+			{
+				//+0 so -0 and 0 hash the same, they compare equal
+				unsigned int h = 2166136261u;
+				for (int i = 0; i < 8; i++)
+				{
+					float value = key.values[i] + 0.0f;
+					unsigned int bits;
+					memcpy(&bits, &value, sizeof(bits));
+					h = (h ^ bits) * 16777619u;
+				}
+				return h;
+			}
+		};
+
+		//Forsyth's vertex scoring, see "Linear-Speed Vertex Cache Optimisation"
+		const float CACHE_DECAY_POWER = 1.5f;
+		const float LAST_TRIANGLE_SCORE = 0.75f;
+		const float VALENCE_BOOST_SCALE = 2.0f;
+		const float VALENCE_BOOST_POWER = 0.5f;
+
+		float scoreVertex(int cachePosition, unsigned int remainingTriangles)
+		{
+			if (remainingTriangles == 0)
+			{
+				return -1.0f;
+			}
+
+			float score = 0;
+			if (cachePosition >= 0)
+			{
+				if (cachePosition < 3)
+				{
+					//the triangle just emitted, deliberately not the best so strips don't spiral
+					score = LAST_TRIANGLE_SCORE;
+				}
+				else
+				{
+					float scaler = 1.0f / (MeshOptimizer::CACHE_SIZE - 3);
+					score = std::pow(1.0f - (cachePosition - 3) * scaler, CACHE_DECAY_POWER);
+				}
+			}
+			//favour vertices with few triangles left so they get finished off
+			score += VALENCE_BOOST_SCALE * std::pow((float)remainingTriangles, -VALENCE_BOOST_POWER);
+			return score;
+		}
+	}
+
+	void MeshOptimizer::weld(vector<vec3>& positions, vector<vec2>& uvs, vector<vec3>& normals, vector<unsigned int>& indices)
+	{
+		bool hasUVs = uvs.size() == positions.size();
+		bool hasNormals = normals.size() == positions.size();
+
+		std::unordered_map<VertexKey, unsigned int, VertexKeyHash> unique;
+		unique.reserve(positions.size());
+		vector<unsigned int> remap(positions.size());
+		unsigned int count = 0;
+
+		for (unsigned int i = 0; i < positions.size(); i++)
+		{
+			VertexKey key = { {
+				positions[i].x, positions[i].y, positions[i].z,
+				hasUVs ? uvs[i].x : 0, hasUVs ? uvs[i].y : 0,
+				hasNormals ? normals[i].x : 0, hasNormals ? normals[i].y : 0, hasNormals ? normals[i].z : 0
+			} };
+
+			auto inserted = unique.emplace(key, count);
+			if (inserted.second)
+			{
+				//compact in place, count never passes i
+				positions[count] = positions[i];
+				if (hasUVs) uvs[count] = uvs[i];
+				if (hasNormals) normals[count] = normals[i];
+				count++;
+			}
+			remap[i] = inserted.first->second;
+		}
+
+		positions.resize(count);
+		if (hasUVs) uvs.resize(count);
+		if (hasNormals) normals.resize(count);
+		for (unsigned int i = 0; i < indices.size(); i++)
+		{
+			indices[i] = remap[indices[i]];
+		}
+	}
+
+	void MeshOptimizer::optimizeVertexCache(vector<unsigned int>& indices, unsigned int vertexCount)
+	{
+		unsigned int triangleCount = indices.size() / 3;
+		if (triangleCount == 0)
+		{
+			return;
+		}
+
+		//triangles using each vertex, packed into one array
+		vector<unsigned int> remaining(vertexCount, 0);
+		for (unsigned int i = 0; i < triangleCount * 3; i++)
+		{
+			remaining[indices[i]]++;
+		}
+		vector<unsigned int> adjacencyOffset(vertexCount + 1, 0);
+		for (unsigned int v = 0; v < vertexCount; v++)
+		{
+			adjacencyOffset[v + 1] = adjacencyOffset[v] + remaining[v];
+		}
+		vector<unsigned int> adjacency(triangleCount * 3);
+		vector<unsigned int> fill(adjacencyOffset.begin(), adjacencyOffset.end() - 1);
+		for (unsigned int t = 0; t < triangleCount; t++)
+		{
+			for (int c = 0; c < 3; c++)
+			{
+				unsigned int v = indices[t * 3 + c];
+				adjacency[fill[v]++] = t;
+			}
+		}
+
+		vector<int> cachePosition(vertexCount, -1);
+		vector<float> vertexScore(vertexCount);
+		for (unsigned int v = 0; v < vertexCount; v++)
+		{
+			vertexScore[v] = scoreVertex(-1, remaining[v]);
+		}
+
+		vector<float> triangleScore(triangleCount);
+		vector<unsigned char> emitted(triangleCount, 0);
+		int best = -1;
+		float bestScore = -1;
+		for (unsigned int t = 0; t < triangleCount; t++)
+		{
+			triangleScore[t] = vertexScore[indices[t * 3]] + vertexScore[indices[t * 3 + 1]] + vertexScore[indices[t * 3 + 2]];
+			if (triangleScore[t] > bestScore)
+			{
+				bestScore = triangleScore[t];
+				best = t;
+			}
+		}
+
+		vector<unsigned int> output;
+		output.reserve(triangleCount * 3);
+		//LRU, with room for the three vertices pushed in before the tail falls off
+		vector<unsigned int> cache, nextCache;
+		cache.reserve(CACHE_SIZE + 3);
+		nextCache.reserve(CACHE_SIZE + 3);
+		unsigned int nextUnemitted = 0;
+
+		for (unsigned int emittedCount = 0; emittedCount < triangleCount; emittedCount++)
+		{
+			if (best < 0)
+			{
+				//nothing in the cache touches a triangle that is left, take the next one in the original order
+				while (emitted[nextUnemitted]) nextUnemitted++;
+				best = nextUnemitted;
+			}
+
+			unsigned int t = best;
+			emitted[t] = 1;
+			nextCache.clear();
+			for (int c = 0; c < 3; c++)
+			{
+				unsigned int v = indices[t * 3 + c];
+				output.push_back(v);
+				nextCache.push_back(v);
+
+				//drop t from the vertex's live triangles
+				unsigned int* begin = &adjacency[adjacencyOffset[v]];
+				unsigned int* end = begin + remaining[v];
+				for (unsigned int* it = begin; it != end; it++)
+				{
+					if (*it == t)
+					{
+						*it = *(end - 1);
+						break;
+					}
+				}
+				remaining[v]--;
+			}
+			for (unsigned int i = 0; i < cache.size(); i++)
+			{
+				unsigned int v = cache[i];
+				if (v != nextCache[0] && v != nextCache[1] && v != nextCache[2])
+				{
+					nextCache.push_back(v);
+				}
+			}
+
+			//everything pushed out loses its cache bonus
+			for (unsigned int i = CACHE_SIZE; i < nextCache.size(); i++)
+			{
+				cachePosition[nextCache[i]] = -1;
+				vertexScore[nextCache[i]] = scoreVertex(-1, remaining[nextCache[i]]);
+			}
+			if (nextCache.size() > CACHE_SIZE)
+			{
+				nextCache.resize(CACHE_SIZE);
+			}
+			cache.swap(nextCache);
+
+			for (unsigned int i = 0; i < cache.size(); i++)
+			{
+				cachePosition[cache[i]] = i;
+				vertexScore[cache[i]] = scoreVertex(i, remaining[cache[i]]);
+			}
+
+			//only triangles around cached vertices changed score
+			best = -1;
+			bestScore = -1;
+			for (unsigned int i = 0; i < cache.size(); i++)
+			{
+				unsigned int v = cache[i];
+				for (unsigned int a = 0; a < remaining[v]; a++)
+				{
+					unsigned int other = adjacency[adjacencyOffset[v] + a];
+					float score = triangleScore[other] = vertexScore[indices[other * 3]] + vertexScore[indices[other * 3 + 1]] + vertexScore[indices[other * 3 + 2]];
+					if (score > bestScore)
+					{
+						bestScore = score;
+						best = other;
+					}
+				}
+			}
+		}
+
+		indices.swap(output);
+	}
+
+	void MeshOptimizer::optimizeVertexFetch(vector<vec3>& positions, vector<vec2>& uvs, vector<vec3>& normals, vector<unsigned int>& indices)
+	{
+		bool hasUVs = uvs.size() == positions.size();
+		bool hasNormals = normals.size() == positions.size();
+
+		const unsigned int UNUSED = 0xFFFFFFFF;
+		vector<unsigned int> remap(positions.size(), UNUSED);
+		vector<vec3> newPositions;
+		vector<vec2> newUVs;
+		vector<vec3> newNormals;
+		newPositions.reserve(positions.size());
+
+		for (unsigned int i = 0; i < indices.size(); i++)
+		{
+			unsigned int v = indices[i];
+			if (remap[v] == UNUSED)
+			{
+				remap[v] = newPositions.size();
+				newPositions.push_back(positions[v]);
+				if (hasUVs) newUVs.push_back(uvs[v]);
+				if (hasNormals) newNormals.push_back(normals[v]);
+			}
+			indices[i] = remap[v];
+		}
+
+		//vertices no triangle uses are dropped
+		positions.swap(newPositions);
+		if (hasUVs) uvs.swap(newUVs);
+		if (hasNormals) normals.swap(newNormals);
+	}
+
+	float MeshOptimizer::computeACMR(const vector<unsigned int>& indices, unsigned int cacheSize)
+	{
+		unsigned int triangleCount = indices.size() / 3;
+		if (triangleCount == 0)
+		{
+			return 0;
+		}
+
+		//FIFO like most hardware
+		vector<unsigned int> fifo(cacheSize, 0xFFFFFFFF);
+		unsigned int head = 0;
+		unsigned int misses = 0;
+		for (unsigned int i = 0; i < triangleCount * 3; i++)
+		{
+			bool hit = false;
+			for (unsigned int c = 0; c < cacheSize; c++)
+			{
+				if (fifo[c] == indices[i])
+				{
+					hit = true;
+					break;
+				}
+			}
+			if (!hit)
+			{
+				fifo[head] = indices[i];
+				head = (head + 1) % cacheSize;
+				misses++;
+			}
+		}
+		return (float)misses / triangleCount;
+	}
+
+}
@@ -0,0 +1,25 @@
+#pragma once
+
+#include "RenderResource.h"
+
+namespace ginkgo {
+
+	//import time clean up of triangle lists, vertex attributes are parallel arrays (uvs and normals may be empty)
+	class MeshOptimizer
+	{
+	public:
+		//size of the post transform cache the reorder and the stats are tuned for
+		static const unsigned int CACHE_SIZE = 32;
+
+		//merges vertices with identical position, uv and normal and rewrites the indices to match
+		static void weld(vector<vec3>& positions, vector<vec2>& uvs, vector<vec3>& normals, vector<unsigned int>& indices);
+		//reorders triangles so recently transformed vertices get reused (Forsyth's linear speed algorithm)
+		static void optimizeVertexCache(vector<unsigned int>& indices, unsigned int vertexCount);
+		//reorders vertices into the order the indices first use them
+		static void optimizeVertexFetch(vector<vec3>& positions, vector<vec2>& uvs, vector<vec3>& normals, vector<unsigned int>& indices);
+
+		//average cache miss ratio: transformed vertices per triangle with a FIFO cache, 0.5 is ideal, 3 is no reuse
+		static float computeACMR(const vector<unsigned int>& indices, unsigned int cacheSize = CACHE_SIZE);
+	};
+
+}
@@ -6,10 +6,11 @@
 #include <TinyObjLoader\tiny_obj_loader.h>
 
 #include "ObjLoader.h"
+#include "MeshOptimizer.h"
 
 namespace ginkgo {
 
-	ObjLoader::ObjLoader(const string& path)
+	ObjLoader::ObjLoader(const string& path, ObjLoadStats* stats)
 	{
 		tinyobj::attrib_t attrib;
 		vector<tinyobj::shape_t> shapes;
@@ -79,5 +80,40 @@ namespace ginkgo {
 				}
 			}
 		}
+
+		//flat face normals, what Mesh::addData would have generated for unshared vertices
+		if (normals.size() == 0)
+		{
+			for (unsigned int i = 0; i + 2 < positions.size(); i += 3)
+			{
+				vec3 normal = glm::normalize(glm::cross(positions[i + 1] - positions[i], positions[i + 2] - positions[i]));
+				normals.push_back(normal);
+				normals.push_back(normal);
+				normals.push_back(normal);
+			}
+		}
+
+		if (stats != nullptr)
+		{
+			stats->verticesBefore = positions.size();
+			stats->acmrBefore = MeshOptimizer::computeACMR(indices);
+		}
+
+		MeshOptimizer::weld(positions, uvs, normals, indices);
+		MeshOptimizer::optimizeVertexCache(indices, positions.size());
+		MeshOptimizer::optimizeVertexFetch(positions, uvs, normals, indices);
+
+		if (stats != nullptr)
+		{
+			stats->verticesAfter = positions.size();
+			stats->acmrAfter = MeshOptimizer::computeACMR(indices);
+		}
 	}
-}
\ No newline at end of file
+
+	void ObjLoader::logStats(const string& path, const ObjLoadStats& stats)
+	{
+		std::cout << "Imported " << path << ": " << stats.verticesBefore << " -> " << stats.verticesAfter << " vertices, ACMR "
+			<< stats.acmrBefore << " -> " << stats.acmrAfter << std::endl;
+	}
+
+}
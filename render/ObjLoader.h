@@ -5,6 +5,15 @@
 
 namespace ginkgo {
 
+	//what the mesh optimizer made of a load, for tools that want to report it
+	struct ObjLoadStats
+	{
+		unsigned int verticesBefore;
+		unsigned int verticesAfter;
+		float acmrBefore;
+		float acmrAfter;
+	};
+
 	class ObjLoader
 	{
 	private:
@@ -13,13 +22,17 @@ namespace ginkgo {
 		vector<vec3> normals;
 		vector<unsigned int> indices;
 	public:
-		ObjLoader(const string& path);
+		//stats is only filled (and the ACMR only measured) when given
+		ObjLoader(const string& path, ObjLoadStats* stats = nullptr);
 		
 		const vector<vec3>& getPositionList() const { return positions; }
 		const vector<vec2>& getUVList() const { return uvs; }
 		const vector<vec3>& getNormalList() const { return normals; }
 		const vector<unsigned int>& getIndexList() const { return indices; }
 
+		//one line with the before/after vertex count and ACMR
+		static void logStats(const string& path, const ObjLoadStats& stats);
+
 	};
 
 
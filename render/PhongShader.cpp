@@ -1,14 +1,29 @@
 #include <iostream>
+#include <cstring>
+#include <cmath>
 
 #include "PhongShader.h"
 
 #include "Material.h"
 #include "LightStructs.h"
+#include "GLState.h"
 
 
 namespace ginkgo {
 
+	namespace
+	{
+		GLint getUniformAlignment()
+		{
+			GLint alignment = 0;
+			glGetIntegerv(GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT, &alignment);
+			return glm::max(alignment, 1);
+		}
+	}
+
 	PhongShader::PhongShader()
+		: lightStream(((GLsizeiptr)sizeof(LightBlock) + getUniformAlignment() - 1) / getUniformAlignment() * getUniformAlignment()),
+		uniformAlignment(getUniformAlignment())
 	{
 		addVertexShader("shaders/phongVertex.vs");
 		addFragmentShader("shaders/phongFragment.fs");
@@ -19,35 +34,75 @@ namespace ginkgo {
 		directionalLight = DirectionalLight(BaseLight(vec4(1.0f, 1.0f, 1.0f, 1.0f), 0.0f), vec3(0.0f, 0.0f, 0.0f));
 	}
 
+	void PhongShader::linked()
+	{
+		static const char* const uniformNames[U_COUNT] = {
+			"transform", "baseColor", "specularIntensity", "specularPower",
+			"refractiveIndex", "hasTexture", "rIntensity", "diffuseTexture", "skybox",
+			"pointLights", "lightClusters", "lightIndices", "textureLodScale"
+		};
+		cacheUniformIDs(uniformNames, U_COUNT);
+
+		bind();
+		setUniform1i(U_DIFFUSETEXTURE, 0); //dependant on phongFragment.fs
+		setUniform1i(U_SKYBOX, 1);		   //dependant on phongFragment.fs
+		setUniform1i(U_POINTLIGHTS, LIGHT_CLUSTER_UNIT);
+		setUniform1i(U_LIGHTCLUSTERS, LIGHT_CLUSTER_UNIT + 1);
+		setUniform1i(U_LIGHTINDICES, LIGHT_CLUSTER_UNIT + 2);
+		setUniform1f(U_TEXTURELODSCALE, 1.0f);
+		unbind();
+
+		glUniformBlockBinding(getProgram(), glGetUniformBlockIndex(getProgram(), "Lights"), LIGHT_BLOCK_BINDING);
+	}
+
 	PhongShader::~PhongShader()
 	{
+	}
 
+	void PhongShader::updateFrameUniforms(const mat4& projection, const mat4& view, const vec3& cameraPosition) const
+	{
+		setUniformMat4(U_TRANSFORM, projection * view);
+
+		GLint viewport[4];
+		glGetIntegerv(GL_VIEWPORT, viewport);
+		lightClusters.build(pointLights, projection, view, viewport[2], viewport[3]);
+		lightClusters.bind(LIGHT_CLUSTER_UNIT);
+
+		lightBlock.ambientLight = ambientLight;
+		lightBlock.directionalColor = directionalLight.base.color;
+		lightBlock.directionalDirection = vec4(directionalLight.direction, directionalLight.base.intensity);
+		lightBlock.cameraPosition = vec4(cameraPosition, 1.0f);
+		//negated third row of the view matrix, view space looks down -z
+		lightBlock.viewDepth = -vec4(view[0][2], view[1][2], view[2][2], view[3][2]);
+		lightBlock.clusterScale = lightClusters.getClusterScale();
+
+		//every draw that read last frame's block has been issued by now, so that's where its fence goes
+		lightStream.endFrame();
+		lightStream.beginFrame();
+		GLintptr offset;
+		memcpy(lightStream.allocate(sizeof(LightBlock), uniformAlignment, offset), &lightBlock, sizeof(LightBlock));
+		lightStream.flush();
+		GLState::bindBufferRange(GL_UNIFORM_BUFFER, LIGHT_BLOCK_BINDING, lightStream.getBuffer(), offset, sizeof(LightBlock));
 	}
 
-	void PhongShader::updateUniforms(const mat4& model, const mat4& transformProjectionViewModel, const Material& material, const vec3& cameraPosition) const
+	void PhongShader::setTextureLodBias(float bias)
 	{
-		setUniformMat4("model", model);
-		setUniformMat4("transform", transformProjectionViewModel);
+		bind();
+		setUniform1f(U_TEXTURELODSCALE, std::exp2(bias));
+	}
 
+	void PhongShader::updateUniforms(const Material& material) const
+	{
 		if (material.texture != nullptr)
 		{
-			setUniform4f("baseColor", material.color);
-			setUniform4f("ambientLight", ambientLight);
-			setUniform("directionalLight", directionalLight);
-			setUniform1f("specularIntensity", material.specularIntensity);
-			setUniform1f("specularPower", material.specularPower);
-
-			for (unsigned int i = 0; i < pointLights.size(); i++)
-			{
-				setUniform("pointLights[" + std::to_string(i) + "]", pointLights[i].second);
-			}
+			setUniform4f(U_BASECOLOR, material.color);
+			setUniform1f(U_SPECULARINTENSITY, material.specularIntensity);
+			setUniform1f(U_SPECULARPOWER, material.specularPower);
 		}
 
-		setUniform3f("cameraPosition", cameraPosition);
-
-		setUniform1f("refractiveIndex", material.refractiveIndex);
-		setUniform1i("hasTexture", material.texture != nullptr);
-		setUniform1f("rIntensity", material.rIntensity);
+		setUniform1f(U_REFRACTIVEINDEX, material.refractiveIndex);
+		setUniform1i(U_HASTEXTURE, material.texture != nullptr);
+		setUniform1f(U_RINTENSITY, material.rIntensity);
 	}
 
 
@@ -114,27 +169,6 @@ namespace ginkgo {
 		return invalid;
 	}
 
-	void PhongShader::setUniform(const string& name, const BaseLight& baseLight) const
-	{
-		setUniform4f((name + ".color").c_str(), baseLight.color);
-		setUniform1f((name + ".intensity").c_str(), baseLight.intensity);
-	}
-
-	void PhongShader::setUniform(const string& name, const DirectionalLight& DirectionalLight) const
-	{
-		setUniform((name + ".base").c_str(), directionalLight.base);
-		setUniform3f((name + ".direction").c_str(), directionalLight.direction);
-	}
-
-	void PhongShader::setUniform(const string& name, const PointLight& pointLight) const
-	{
-		setUniform((name + ".base").c_str(), pointLight.base);
-		setUniform1f((name + ".attenuation.constant").c_str(), pointLight.attenuation.constant);
-		setUniform1f((name + ".attenuation.linear").c_str(), pointLight.attenuation.linear);
-		setUniform1f((name + ".attenuation.quadratic").c_str(), pointLight.attenuation.quadratic);
-		setUniform3f((name + ".position").c_str(), pointLight.position);
-	}
-
 	IPhongShader* phongShaderFactory()
 	{
 		return new PhongShader();
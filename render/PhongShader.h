@@ -2,6 +2,8 @@
 
 #include "IPhongShader.h"
 #include "Shader.h"
+#include "LightClusters.h"
+#include "StreamBuffer.h"
 #include <glm/glm.hpp>
 #include <utility>
 
@@ -9,6 +11,16 @@ namespace ginkgo {
 	
 	struct Material;
 
+	//std140 layout of the Lights block in phongFragment.fs, point lights come from LightClusters
+	struct LightBlock
+	{
+		vec4 ambientLight;
+		vec4 directionalColor;
+		vec4 directionalDirection; //w = intensity
+		vec4 cameraPosition;
+		vec4 viewDepth; //dot with a world position for its view space depth
+		vec4 clusterScale; //see LightClusters::getClusterScale
+	};
 
 	class PhongShader : public Shader, public IPhongShader
 	{
@@ -21,10 +33,28 @@ namespace ginkgo {
 		
 		int lightCounter;
 
+		enum UniformID
+		{
+			U_TRANSFORM, U_BASECOLOR, U_SPECULARINTENSITY, U_SPECULARPOWER,
+			U_REFRACTIVEINDEX, U_HASTEXTURE, U_RINTENSITY, U_DIFFUSETEXTURE, U_SKYBOX,
+			U_POINTLIGHTS, U_LIGHTCLUSTERS, U_LIGHTINDICES, U_TEXTURELODSCALE,
+			U_COUNT
+		};
+		static const GLuint LIGHT_BLOCK_BINDING = 0;
+		static const GLuint LIGHT_CLUSTER_UNIT = 2; //and the two after, 0 and 1 are the diffuse texture and the skybox
+
+		//a fresh Lights block each frame, bound by range
+		mutable StreamBuffer lightStream;
+		GLint uniformAlignment;
+		mutable LightBlock lightBlock;
+		mutable LightClusters lightClusters;
+
+		void linked() override;
 	public:
 		PhongShader();
 		~PhongShader();
-		void updateUniforms(const mat4& model, const mat4& transformProjectionViewModel, const Material& material, const vec3& cameraPosition) const override;
+		void updateFrameUniforms(const mat4& projection, const mat4& view, const vec3& cameraPosition) const override;
+		void updateUniforms(const Material& material) const override;
 
 		const vec4& getAmbientLight() const override { return ambientLight; }
 		void setAmbientLight(const vec4& ambientLight) override { this->ambientLight = ambientLight; }
@@ -36,11 +66,10 @@ namespace ginkgo {
 		const PointLight& getPointLight(int index) override;
 
 		const DirectionalLight& getDirectionalLight() const override { return directionalLight; }
+		unsigned int getVisiblePointLightCount() const override { return lightClusters.getLightCount(); }
+		void setTextureLodBias(float bias) override;
+		void setMaxLightsPerCluster(unsigned int count) override { lightClusters.setMaxLightsPerCluster(count); }
 		void setDirectionalLight(const DirectionalLight& directionalLight) override;
-		
-		void setUniform(const string& name, const DirectionalLight& directionalLight) const override;
-		void setUniform(const string& name, const BaseLight& baseLight) const override;
-		void setUniform(const string& name, const PointLight& pointLight) const override;
 	};
 
 
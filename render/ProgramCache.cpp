@@ -0,0 +1,164 @@
+#include <fstream>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+
+#include "ProgramCache.h"
+#include "MappedFile.h"
+
+namespace ginkgo {
+
+	namespace
+	{
+		const uint64_t FNV_OFFSET = 14695981039346656037ull;
+		const uint64_t FNV_PRIME = 1099511628211ull;
+
+		bool saveFailed(const string& cachePath)
+		{
+			static bool reported = false;
+			if (!reported)
+			{
+				std::cout << "Failed to write program cache " << cachePath << ", shaders are compiled again on every run!" << std::endl;
+				reported = true;
+			}
+			return false;
+		}
+
+		void hashBytes(uint64_t& hash, const char* bytes, size_t length)
+		{
+			for (size_t i = 0; i < length; i++)
+			{
+				hash = (hash ^ (unsigned char)bytes[i]) * FNV_PRIME;
+			}
+			//terminator so "ab" + "c" and "a" + "bc" differ
+			hash = (hash ^ 0xFF) * FNV_PRIME;
+		}
+
+		void hashGLString(uint64_t& hash, GLenum name)
+		{
+			const char* value = (const char*)glGetString(name);
+			if (value != nullptr)
+			{
+				hashBytes(hash, value, strlen(value));
+			}
+		}
+	}
+
+	bool ProgramCache::isSupported()
+	{
+		if (!GLEW_ARB_get_program_binary)
+		{
+			return false;
+		}
+		GLint formats = 0;
+		glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &formats);
+		return formats > 0;
+	}
+
+	void ProgramCache::enableParallelCompile()
+	{
+		static bool enabled = false;
+		if (enabled)
+		{
+			return;
+		}
+		enabled = true;
+		//same entry point and token as the KHR version
+		if (GLEW_ARB_parallel_shader_compile)
+		{
+			glMaxShaderCompilerThreadsARB(0xFFFFFFFF); //as many as the driver likes
+		}
+	}
+
+	uint64_t ProgramCache::makeKey(const vector<string>& sources)
+	{
+		uint64_t key = FNV_OFFSET;
+		hashGLString(key, GL_VENDOR);
+		hashGLString(key, GL_RENDERER);
+		hashGLString(key, GL_VERSION);
+		for (unsigned int i = 0; i < sources.size(); i++)
+		{
+			hashBytes(key, sources[i].c_str(), sources[i].size());
+		}
+		return key;
+	}
+
+	string ProgramCache::getCachePath(const vector<string>& sourcePaths)
+	{
+		uint64_t hash = FNV_OFFSET;
+		for (unsigned int i = 0; i < sourcePaths.size(); i++)
+		{
+			hashBytes(hash, sourcePaths[i].c_str(), sourcePaths[i].size());
+		}
+
+		string directory;
+		if (!sourcePaths.empty())
+		{
+			size_t slash = sourcePaths[0].find_last_of("/\\");
+			if (slash != string::npos)
+			{
+				directory = sourcePaths[0].substr(0, slash + 1);
+			}
+		}
+		char name[32];
+		snprintf(name, sizeof(name), "%016llx.glprog", (unsigned long long)hash);
+		return directory + name;
+	}
+
+	bool ProgramCache::load(GLuint program, const string& cachePath, uint64_t key)
+	{
+		if (!isSupported())
+		{
+			return false;
+		}
+
+		MappedFile cache(cachePath);
+		if (cache.getSize() < sizeof(ProgramCacheHeader))
+		{
+			return false;
+		}
+		const ProgramCacheHeader& header = *(const ProgramCacheHeader*)cache.getData();
+		if (header.magic != ProgramCacheHeader::MAGIC || header.version != ProgramCacheHeader::VERSION || header.key != key ||
+			cache.getSize() != sizeof(ProgramCacheHeader) + header.binaryLength)
+		{
+			return false;
+		}
+
+		glProgramBinary(program, header.binaryFormat, cache.getData() + sizeof(ProgramCacheHeader), header.binaryLength);
+		//drivers may still refuse a binary they wrote themselves
+		GLint linked = GL_FALSE;
+		glGetProgramiv(program, GL_LINK_STATUS, &linked);
+		return linked == GL_TRUE;
+	}
+
+	bool ProgramCache::save(GLuint program, const string& cachePath, uint64_t key)
+	{
+		if (!isSupported())
+		{
+			return false;
+		}
+
+		GLint length = 0;
+		glGetProgramiv(program, GL_PROGRAM_BINARY_LENGTH, &length);
+		if (length <= 0)
+		{
+			return false;
+		}
+		vector<char> binary(length);
+		GLenum format;
+		glGetProgramBinary(program, length, &length, &format, &binary[0]);
+
+		ProgramCacheHeader header;
+		header.magic = ProgramCacheHeader::MAGIC;
+		header.version = ProgramCacheHeader::VERSION;
+		header.key = key;
+		header.binaryFormat = format;
+		header.binaryLength = length;
+
+		std::ofstream out(cachePath, std::ios::binary | std::ios::trunc);
+		out.write((const char*)&header, sizeof(header));
+		out.write(&binary[0], length);
+		return out.good() || saveFailed(cachePath);
+	}
+
+}
@@ -0,0 +1,43 @@
+#pragma once
+
+#include "RenderResource.h"
+#include <GL/glew.h>
+#include <cstdint>
+
+namespace ginkgo {
+
+	//linked program as glGetProgramBinary hands it out
+	//file layout: ProgramCacheHeader | binary (binaryLength bytes)
+	struct ProgramCacheHeader
+	{
+		static const uint32_t MAGIC = 0x47525047; //"GPRG"
+		static const uint32_t VERSION = 1;
+
+		uint32_t magic;
+		uint32_t version;
+		uint64_t key; //see ProgramCache::makeKey
+		uint32_t binaryFormat;
+		uint32_t binaryLength;
+	};
+
+	class ProgramCache
+	{
+	public:
+		//false if the driver can't hand out program binaries (or offers no format), every program then compiles
+		static bool isSupported();
+		//asks the driver to compile on its own threads where it can (ARB/KHR_parallel_shader_compile), once per context
+		static void enableParallelCompile();
+
+		//FNV-1a over the sources and the driver's vendor, renderer and version, so edits and driver updates both miss
+		static uint64_t makeKey(const vector<string>& sources);
+		//next to the first source, named after all of their paths
+		static string getCachePath(const vector<string>& sourcePaths);
+
+		//false on a miss or if the driver rejects the binary, program is then left for the caller to compile
+		static bool load(GLuint program, const string& cachePath, uint64_t key);
+		//program must be linked, and created retrievable (GL_PROGRAM_BINARY_RETRIEVABLE_HINT) before linking
+		//false without binary support, or on io failure (only the first one is logged)
+		static bool save(GLuint program, const string& cachePath, uint64_t key);
+	};
+
+}
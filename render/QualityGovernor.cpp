@@ -0,0 +1,86 @@
+#include "QualityGovernor.h"
+
+namespace ginkgo {
+
+	namespace
+	{
+		//best first, each step gives up a little more than the one before
+		const QualitySettings LEVELS[QualityGovernor::LEVEL_COUNT] = {
+			{ 1.0f,  0.0f, 64 },
+			{ 1.0f,  0.0f, 32 },
+			{ 0.85f, 0.5f, 32 },
+			{ 0.75f, 0.5f, 16 },
+			{ 0.67f, 1.0f, 16 },
+			{ 0.5f,  1.0f, 8 }
+		};
+
+		const double AVERAGE_WEIGHT = 0.1; //of each new frame in the moving average
+		const double SPIKE_LIMIT = 4.0; //frames longer than this many targets (loads, hitches) count as only this long
+		const double OVER_BUDGET = 1.05;
+		const double UNDER_BUDGET = 0.8; //needs real headroom, stepping up costs more than the step down saved
+		const unsigned int DEGRADE_FRAMES = 10;
+		const unsigned int IMPROVE_FRAMES = 120;
+	}
+
+	QualityGovernor::QualityGovernor(double targetFrameTime)
+		: targetFrameTime(targetFrameTime), averageFrameTime(targetFrameTime), level(0), framesOver(0), framesUnder(0), enabled(false)
+	{
+	}
+
+	bool QualityGovernor::update(double frameTime)
+	{
+		if (!enabled)
+		{
+			return false;
+		}
+
+		frameTime = glm::min(frameTime, targetFrameTime * SPIKE_LIMIT);
+		averageFrameTime += (frameTime - averageFrameTime) * AVERAGE_WEIGHT;
+
+		framesOver = (averageFrameTime > targetFrameTime * OVER_BUDGET) ? framesOver + 1 : 0;
+		framesUnder = (averageFrameTime < targetFrameTime * UNDER_BUDGET) ? framesUnder + 1 : 0;
+
+		int previous = level;
+		if (framesOver >= DEGRADE_FRAMES && level < LEVEL_COUNT - 1)
+		{
+			level++;
+		}
+		else if (framesUnder >= IMPROVE_FRAMES && level > 0)
+		{
+			level--;
+		}
+		if (level == previous)
+		{
+			return false;
+		}
+		//the average still remembers the old level, let it settle before judging the new one
+		framesOver = 0;
+		framesUnder = 0;
+		return true;
+	}
+
+	void QualityGovernor::setEnabled(bool enabled)
+	{
+		this->enabled = enabled;
+		if (!enabled)
+		{
+			level = 0;
+		}
+		framesOver = 0;
+		framesUnder = 0;
+	}
+
+	void QualityGovernor::setTargetFrameTime(double seconds)
+	{
+		targetFrameTime = seconds;
+		averageFrameTime = seconds;
+		framesOver = 0;
+		framesUnder = 0;
+	}
+
+	const QualitySettings& QualityGovernor::getSettings() const
+	{
+		return LEVELS[level];
+	}
+
+}
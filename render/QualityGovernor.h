@@ -0,0 +1,47 @@
+#pragma once
+
+#include "RenderResource.h"
+
+namespace ginkgo {
+
+	struct QualitySettings
+	{
+		float renderScale; //ScreenBuffer resolution over the window's
+		float textureLodBias; //added to every texture's mip level, log2
+		unsigned int maxLightsPerCluster;
+	};
+
+	//holds a target frame time by stepping through a ladder of quality levels, one step at a time
+	//steps down quickly once frames run over, back up only after a long run of frames with plenty of headroom
+	//off until setEnabled, a game turns it on once it has set a target that fits its present rate
+	class QualityGovernor
+	{
+	private:
+		double targetFrameTime;
+		double averageFrameTime; //moving average, seconds
+		int level;
+		unsigned int framesOver;
+		unsigned int framesUnder;
+		bool enabled;
+	public:
+		static const int LEVEL_COUNT = 6;
+
+		QualityGovernor(double targetFrameTime);
+
+		//once a frame with what the frame's own work took in seconds, true if the settings changed
+		//waits for vsync or a frame limiter mustn't be part of it, a capped frame rate would read as a slow one
+		bool update(double frameTime);
+
+		//disabled stays at (or goes back to) full quality
+		void setEnabled(bool enabled);
+		bool isEnabled() const { return enabled; }
+		void setTargetFrameTime(double seconds);
+		double getTargetFrameTime() const { return targetFrameTime; }
+
+		double getAverageFrameTime() const { return averageFrameTime; }
+		//0 is full quality
+		int getLevel() const { return level; }
+		const QualitySettings& getSettings() const;
+	};
+
+}
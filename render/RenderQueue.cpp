@@ -0,0 +1,57 @@
+#include <utility>
+
+#include "RenderQueue.h"
+
+namespace ginkgo {
+
+	void RenderQueue::sort()
+	{
+		unsigned int count = entries.size();
+		if (count < 2)
+		{
+			return;
+		}
+		scratch.resize(count);
+
+		//all eight histograms in one pass over the keys
+		unsigned int histograms[8][256] = {};
+		for (unsigned int i = 0; i < count; i++)
+		{
+			SortKey key = entries[i].key;
+			for (int b = 0; b < 8; b++)
+			{
+				histograms[b][(key >> (b * 8)) & 0xFF]++;
+			}
+		}
+
+		Entry* src = &entries[0];
+		Entry* dst = &scratch[0];
+		for (int b = 0; b < 8; b++)
+		{
+			unsigned int* histogram = histograms[b];
+			if (histogram[(src[0].key >> (b * 8)) & 0xFF] == count)
+			{
+				continue;
+			}
+
+			unsigned int offset = 0;
+			for (int d = 0; d < 256; d++)
+			{
+				unsigned int n = histogram[d];
+				histogram[d] = offset;
+				offset += n;
+			}
+			for (unsigned int i = 0; i < count; i++)
+			{
+				dst[histogram[(src[i].key >> (b * 8)) & 0xFF]++] = src[i];
+			}
+			std::swap(src, dst);
+		}
+
+		if (src != &entries[0])
+		{
+			entries.swap(scratch);
+		}
+	}
+
+}
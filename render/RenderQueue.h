@@ -0,0 +1,60 @@
+#pragma once
+
+#include "RenderResource.h"
+
+namespace ginkgo {
+
+	typedef unsigned long long SortKey;
+
+	//packed draw order, most significant first:
+	//pass (2) | shader (4) | texture (12) | material (12) | mesh (16) | depth (18)
+	namespace SortKeys
+	{
+		enum Pass
+		{
+			PASS_OPAQUE = 0,
+			PASS_REFRACTIVE = 1, //needs the cube map bound
+		};
+
+		static const unsigned int DEPTH_BITS = 18;
+		static const unsigned int DEPTH_MAX = (1u << DEPTH_BITS) - 1;
+
+		inline SortKey make(unsigned int pass, unsigned int shader, unsigned int texture, unsigned int material, unsigned int mesh, unsigned int depth)
+		{
+			return ((SortKey)(pass & 0x3) << 62) |
+				((SortKey)(shader & 0xF) << 58) |
+				((SortKey)(texture & 0xFFF) << 46) |
+				((SortKey)(material & 0xFFF) << 34) |
+				((SortKey)(mesh & 0xFFFF) << 18) |
+				((SortKey)(depth & DEPTH_MAX));
+		}
+
+		inline unsigned int getPass(SortKey key) { return (unsigned int)(key >> 62); }
+	}
+
+	//rebuilt every frame: push one key per draw, sort, then walk in order
+	class RenderQueue
+	{
+	public:
+		struct Entry
+		{
+			SortKey key;
+			unsigned int index;
+		};
+
+	private:
+		vector<Entry> entries;
+		vector<Entry> scratch;
+
+	public:
+		void clear() { entries.clear(); }
+		void push(SortKey key, unsigned int index) { entries.push_back({ key, index }); }
+
+		//LSD radix sort, 8 bits a pass, passes where every key has the same byte are skipped
+		void sort();
+
+		unsigned int size() const { return entries.size(); }
+		const Entry& operator[](unsigned int i) const { return entries[i]; }
+	};
+
+}
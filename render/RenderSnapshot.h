@@ -0,0 +1,87 @@
+#pragma once
+
+#include "RenderResource.h"
+#include <glm/gtx/quaternion.hpp>
+#include <atomic>
+#include <chrono>
+
+namespace ginkgo
+{
+	//everything the renderer needs to place one renderable for one simulation tick
+	struct TransformState
+	{
+		TransformState(int UID, const vec3& position, const quat& rotation, const vec3& scale)
+			: UID(UID), position(position), rotation(rotation), scale(scale)
+		{}
+
+		int UID;
+		vec3 position;
+		quat rotation;
+		vec3 scale; //not interpolated
+	};
+
+	//immutable once published
+	struct RenderSnapshot
+	{
+		RenderSnapshot()
+			: publishTime(0)
+		{}
+
+		//seconds on the steady clock when the simulation published this snapshot
+		double publishTime;
+		vector<TransformState> transforms;
+
+		static double now()
+		{
+			return std::chrono::duration<double>(std::chrono::steady_clock::now().time_since_epoch()).count();
+		}
+	};
+
+	//lock free handoff of the newest T from one producer thread to one consumer thread
+	//the producer always has a slot to write, the consumer always has a slot to read,
+	//and the third slot holds whatever was published last
+	template<typename T>
+	class TripleBuffer
+	{
+	private:
+		static const unsigned int FRESH = 4;
+
+		T slots[3];
+		unsigned int writeIndex;
+		unsigned int readIndex;
+		//index of the published slot, FRESH set when the consumer hasn't seen it yet
+		std::atomic<unsigned int> middle;
+
+	public:
+		TripleBuffer()
+			: writeIndex(0), readIndex(1), middle(2)
+		{}
+
+		//producer side
+		T& getWriteSlot() { return slots[writeIndex]; }
+
+		void publish()
+		{
+			writeIndex = middle.exchange(writeIndex | FRESH, std::memory_order_acq_rel) & ~FRESH;
+		}
+
+		//consumer side
+		bool isFresh() const
+		{
+			return (middle.load(std::memory_order_acquire) & FRESH) != 0;
+		}
+
+		//returns true if a newer slot was picked up
+		bool acquire()
+		{
+			if (!isFresh())
+			{
+				return false;
+			}
+			readIndex = middle.exchange(readIndex, std::memory_order_acq_rel) & ~FRESH;
+			return true;
+		}
+
+		const T& getReadSlot() const { return slots[readIndex]; }
+	};
+}
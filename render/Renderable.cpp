@@ -11,7 +11,7 @@ namespace ginkgo {
 	int Renderable::index = 0;
 
 	Renderable::Renderable(const Mesh* mesh, Material* material)
-		: mesh(mesh), material(material)
+		: mesh(mesh), material(material), stateVersion(0)
 	{
 		r_index = index;
 		index++;
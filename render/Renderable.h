@@ -18,11 +18,12 @@ namespace ginkgo {
 		Transform model;
 		static int index;
 		int r_index;
+		unsigned int stateVersion;
 	public:
 		Renderable(const Mesh* mesh, Material* material);
 
-		void setMesh(const Mesh* mesh) override { this->mesh = mesh; }
-		void setMaterial(Material* material) override { this->material = material; }
+		void setMesh(const Mesh* mesh) override { this->mesh = mesh; stateVersion++; }
+		void setMaterial(Material* material) override { this->material = material; stateVersion++; }
 		Material& getMaterial() override { return *material; }
 		
 		const mat4& getModel() const override;
@@ -33,6 +34,7 @@ namespace ginkgo {
 		const Material& getMaterial() const override { return *material; }
 
 		const int getIndex() const override { return r_index; }
+		unsigned int getStateVersion() const override { return stateVersion; }
 
 		void draw() const override;
 
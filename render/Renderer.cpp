@@ -7,21 +7,39 @@
 #include "IWindow.h"
 #include "ILayer.h"
 #include "ICamera.h"
+#include "IRenderable.h"
+#include "ITransform.h"
+#include "ResourceManagement.h"
+#include "GLState.h"
+#include "FrameCapture.h"
+#include "TransformHierarchy.h"
 
 namespace ginkgo
 {
 	Renderer* primaryRenderer = nullptr;
 
+	//GL time per frame spent on finished asynchronous loads
+	static const double ASSET_UPLOAD_BUDGET_MS = 2.0;
+	static const double DEFAULT_TARGET_FRAME_TIME = 1.0 / 60.0;
+
 	Renderer::Renderer(IWindow* window)
+		: governor(DEFAULT_TARGET_FRAME_TIME)
 	{
 		skybox = nullptr;
 		textRenderer = nullptr;
 		this->window = window;
 		textCounter = 0;
+		stateChangeCount = 0;
+		elidedStateChangeCount = 0;
 		camera = cameraFactory(window);
 		renderLayer = layerFactory();
 		lighting = phongShaderFactory();
 		renderSurface = new ScreenBuffer(window->getWidth(), window->getHeight(), glm::vec4(0, 0, 0, 0), false, false);
+		frameCapture = new FrameCapture();
+		glGenQueries(FRAME_QUERY_COUNT, frameQueries);
+		frameQueryIndex = 0;
+		gpuFrameTime = 0;
+		applyQuality();
 	}
 
 	int Renderer::addRenderable(IRenderable* renderable)
@@ -39,6 +57,11 @@ namespace ginkgo
 		return renderLayer->alterRenderable(UID);
 	}
 
+	unsigned int Renderer::bakeStaticGeometry(const vector<int>& UIDs, float chunkSize)
+	{
+		return renderLayer->bakeStatic(UIDs, chunkSize);
+	}
+
 	void Renderer::setDirectionalLight(const DirectionalLight& directionalLight)
 	{
 		lighting->setDirectionalLight(directionalLight);
@@ -86,41 +109,73 @@ namespace ginkgo
 
 	void Renderer::createTextComponent(string const& path, int fontSize)
 	{
+		delete textRenderer;
 		textRenderer = textRenderFactory(window->getWidth(), window->getHeight(), path.c_str(), fontSize);
+		//labels added before there was a font
+		for (auto& pair : textLabels)
+		{
+			retainTextLabel(pair.second);
+		}
+	}
+
+	void Renderer::retainTextLabel(TextLabel& label)
+	{
+		if (textRenderer != nullptr)
+		{
+			label.region = textRenderer->retain(label.text, label.x, label.y, label.scale, label.color);
+		}
+	}
+
+	void Renderer::updateTextLabel(const TextLabel& label)
+	{
+		if (textRenderer != nullptr)
+		{
+			textRenderer->update(label.region, label.text, label.x, label.y, label.scale, label.color);
+		}
 	}
 
 	int Renderer::addText(string const& text, float x, float y, float scale, vec3 const& color)
 	{
 		textLabels[textCounter] = TextLabel(text, x, y, scale, color);
+		retainTextLabel(textLabels[textCounter]);
 		return textCounter++;
 	}
 
 	void Renderer::setTextPosition(int index, float x, float y)
 	{
-		if (textLabels.find(index) != textLabels.end())
+		auto it = textLabels.find(index);
+		if (it != textLabels.end())
 		{
-			textLabels[index].x = x;
-			textLabels[index].y = y;
+			it->second.x = x;
+			it->second.y = y;
+			updateTextLabel(it->second);
 		}
 	}
 
 	void Renderer::removeText(int index)
 	{
-		if (textLabels.find(index) == textLabels.end())
+		auto it = textLabels.find(index);
+		if (it == textLabels.end())
 		{
 			return;
 		}
-		textLabels.erase(index);
+		if (textRenderer != nullptr)
+		{
+			textRenderer->release(it->second.region);
+		}
+		textLabels.erase(it);
 	}
 
 	void Renderer::editText(int index, string const& text)
 	{
-		if (textLabels.find(index) == textLabels.end())
+		auto it = textLabels.find(index);
+		if (it == textLabels.end() || it->second.text == text)
 		{
 			return;
 		}
 
-		textLabels[index].text = text;
+		it->second.text = text;
+		updateTextLabel(it->second);
 	}
 
 	void Renderer::loadSkybox(map<unsigned int, string> paths, float scale)
@@ -142,13 +197,155 @@ namespace ginkgo
 		return camera;
 	}
 
+	void Renderer::setTargetFrameTime(double seconds)
+	{
+		governor.setTargetFrameTime(seconds);
+	}
+
+	void Renderer::setAdaptiveQuality(bool enabled)
+	{
+		governor.setEnabled(enabled);
+		applyQuality();
+	}
+
+	void Renderer::setPostProcessing(bool enabled)
+	{
+		renderSurface->setPostProcessing(enabled);
+	}
+
+	void Renderer::applyQuality()
+	{
+		const QualitySettings& settings = governor.getSettings();
+		renderSurface->setRenderScale(settings.renderScale);
+		lighting->setTextureLodBias(settings.textureLodBias);
+		lighting->setMaxLightsPerCluster(settings.maxLightsPerCluster);
+	}
+
+	RenderSnapshot& Renderer::beginSnapshot()
+	{
+		RenderSnapshot& snapshot = snapshots.getWriteSlot();
+		snapshot.transforms.clear();
+		return snapshot;
+	}
+
+	RenderSnapshot& Renderer::getWriteSnapshot()
+	{
+		return snapshots.getWriteSlot();
+	}
+
+	void Renderer::publishSnapshot()
+	{
+		snapshots.getWriteSlot().publishTime = RenderSnapshot::now();
+		snapshots.publish();
+	}
+
+	void Renderer::releaseRenderable(IRenderable* renderable)
+	{
+		std::lock_guard<std::mutex> lock(releasedMutex);
+		released.push_back(renderable);
+	}
+
+	void Renderer::deleteReleased()
+	{
+		vector<IRenderable*> renderables;
+		{
+			std::lock_guard<std::mutex> lock(releasedMutex);
+			renderables.swap(released);
+		}
+		for (IRenderable* renderable : renderables)
+		{
+			renderLayer->removeRenderable(renderable->getIndex());
+			delete renderable;
+		}
+	}
+
+	void Renderer::applySnapshot()
+	{
+		if (snapshots.isFresh())
+		{
+			previousSnapshot = snapshots.getReadSlot();
+			snapshots.acquire();
+
+			previousSlots.clear();
+			for (unsigned int i = 0; i < previousSnapshot.transforms.size(); i++)
+			{
+				previousSlots[previousSnapshot.transforms[i].UID] = i;
+			}
+		}
+		const RenderSnapshot& current = snapshots.getReadSlot();
+		if (current.transforms.empty())
+		{
+			return;
+		}
+
+		//render one tick behind the simulation, blending toward the newest snapshot
+		float alpha = 1;
+		double tickLength = current.publishTime - previousSnapshot.publishTime;
+		if (tickLength > 0)
+		{
+			alpha = (float)glm::clamp((RenderSnapshot::now() - current.publishTime) / tickLength, 0.0, 1.0);
+		}
+
+		const vector<TransformState>& prev = previousSnapshot.transforms;
+		for (unsigned int i = 0; i < current.transforms.size(); i++)
+		{
+			const TransformState& cur = current.transforms[i];
+			IRenderable* renderable = renderLayer->alterRenderable(cur.UID);
+			if (renderable == nullptr)
+			{
+				continue;
+			}
+
+			//same slot as last tick in the usual case, removals shift everything after them so fall back to the UID
+			const TransformState* before = nullptr;
+			if (i < prev.size() && prev[i].UID == cur.UID)
+			{
+				before = &prev[i];
+			}
+			else
+			{
+				auto it = previousSlots.find(cur.UID);
+				if (it != previousSlots.end())
+				{
+					before = &prev[it->second];
+				}
+			}
+
+			if (renderable->getTransform().getScale() != cur.scale)
+			{
+				renderable->getTransform().scaleMatrix(cur.scale);
+			}
+			if (before != nullptr)
+			{
+				renderable->getTransform().translateMatrix(glm::mix(before->position, cur.position, alpha));
+				renderable->getTransform().rotateMatrix(glm::slerp(before->rotation, cur.rotation, alpha));
+			}
+			else
+			{
+				renderable->getTransform().translateMatrix(cur.position);
+				renderable->getTransform().rotateMatrix(cur.rotation);
+			}
+		}
+	}
+
 	void Renderer::renderAndSwap()
 	{
-		mat4 tPVC = camera->getProjection() * camera->getView() * camera->getCameraPositionTranslation();
+		//the governor times from here to just before the swap, waits in the swap or the caller's frame limiter don't count
+		double frameStart = RenderSnapshot::now();
+		glBeginQuery(GL_TIME_ELAPSED, frameQueries[frameQueryIndex % FRAME_QUERY_COUNT]);
+		GLState::resetCounters();
+		uploadLoadedAssets(ASSET_UPLOAD_BUDGET_MS);
+		deleteReleased();
+		applySnapshot();
+		//every transform that moved this frame (snapshot, game code or parent) at once, the draw below only reads them
+		TransformHierarchy::update();
+
+		mat4 view = camera->getView() * camera->getCameraPositionTranslation();
+		mat4 tPVC = camera->getProjection() * view;
 
 		//ScreenBuffer::initalize();
 		renderSurface->drawToTexture();
-		renderLayer->draw(tPVC, camera->getCameraPosition(), *lighting, *skybox);
+		renderLayer->draw(camera->getProjection(), view, camera->getCameraPosition(), *lighting, *skybox);
 
 		if (skybox != nullptr)
 		{
@@ -156,18 +353,90 @@ namespace ginkgo
 		}
 
 		renderSurface->drawToScreen();
+		//labels are retained geometry, this is one draw however many there are
 		if (textRenderer != nullptr)
 		{
-			for (auto pair : textLabels)
-			{
-				const TextLabel& label = pair.second;
-				textRenderer->draw(label.text, label.x, label.y, label.scale, label.color);
-			}
+			textRenderer->flush();
+		}
+		frameCapture->update(window->getWidth(), window->getHeight());
+
+		stateChangeCount = GLState::getIssuedCount();
+		elidedStateChangeCount = GLState::getElidedCount();
+		glEndQuery(GL_TIME_ELAPSED);
+		readFrameQuery();
+		//the CPU and the GPU work in parallel, whichever is slower sets the frame time
+		if (governor.update(glm::max(RenderSnapshot::now() - frameStart, gpuFrameTime)))
+		{
+			//takes effect from the next frame
+			applyQuality();
 		}
-
 		window->update();
 	}
 
+	void Renderer::readFrameQuery()
+	{
+		//the oldest query, the next frame reuses it, by now its result is normally in without waiting on the GPU
+		frameQueryIndex++;
+		if (frameQueryIndex < FRAME_QUERY_COUNT)
+		{
+			return;
+		}
+		GLuint query = frameQueries[frameQueryIndex % FRAME_QUERY_COUNT];
+		GLint available = GL_FALSE;
+		glGetQueryObjectiv(query, GL_QUERY_RESULT_AVAILABLE, &available);
+		if (available)
+		{
+			GLuint64 nanoseconds;
+			glGetQueryObjectui64v(query, GL_QUERY_RESULT, &nanoseconds);
+			gpuFrameTime = nanoseconds / 1e9;
+		}
+	}
+
+	void Renderer::screenshot(const string& path)
+	{
+		frameCapture->screenshot(path);
+	}
+
+	void Renderer::startCapture(const string& path)
+	{
+		frameCapture->startSequence(path);
+	}
+
+	void Renderer::stopCapture()
+	{
+		frameCapture->stopSequence();
+	}
+
+	void Renderer::finishCaptures()
+	{
+		frameCapture->finish();
+	}
+
+	unsigned int Renderer::getDrawnCount() const
+	{
+		return renderLayer->getDrawnCount();
+	}
+
+	unsigned int Renderer::getCulledCount() const
+	{
+		return renderLayer->getCulledCount();
+	}
+
+	unsigned int Renderer::getDrawCallCount() const
+	{
+		return renderLayer->getDrawCallCount();
+	}
+
+	unsigned int Renderer::getStateChangeCount() const
+	{
+		return stateChangeCount;
+	}
+
+	unsigned int Renderer::getElidedStateChangeCount() const
+	{
+		return elidedStateChangeCount;
+	}
+
 	IRenderer* initRenderer(IWindow* window)
 	{ 
 		if (primaryRenderer == nullptr)
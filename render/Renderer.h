@@ -1,6 +1,11 @@
 #pragma once
 
 #include "IRenderer.h"
+#include "RenderSnapshot.h"
+#include "QualityGovernor.h"
+#include <GL/glew.h>
+#include <unordered_map>
+#include <mutex>
 
 
 
@@ -11,15 +16,16 @@ namespace ginkgo
 	class IText;
 	class ICubeMap;
 	class ILayer;
+	class FrameCapture;
 
 	struct TextLabel
 	{
 		TextLabel(string const& text, float x, float y, float scale, vec3 const& color)
-			: text(text), x(x), y(y), scale(scale), color(color)
+			: text(text), x(x), y(y), scale(scale), color(color), region(0)
 		{}
 
 		TextLabel()
-			: text(""), x(0), y(0), scale(1), color(vec4())
+			: text(""), x(0), y(0), scale(1), color(vec4()), region(0)
 		{}
 
 		void operator=(const TextLabel& other)
@@ -29,18 +35,29 @@ namespace ginkgo
 			y = other.y;
 			scale = other.scale;
 			color = other.color;
+			region = other.region;
 		}
 
 		string text;
 		float x, y;
 		float scale;
 		vec3 color;
+		unsigned int region; //its geometry, retained by the text renderer
 	};
 
 	class Renderer : public IRenderer
 	{
 	private:
 		int textCounter;
+		QualityGovernor governor;
+		//GL_TIME_ELAPSED around each frame, read back FRAME_QUERY_COUNT - 1 frames later so it never stalls
+		static const unsigned int FRAME_QUERY_COUNT = 4;
+		GLuint frameQueries[FRAME_QUERY_COUNT];
+		unsigned int frameQueryIndex; //frames so far, the current query is this modulo FRAME_QUERY_COUNT
+		double gpuFrameTime; //seconds, the latest result that came back
+		//GLState counters for the last renderAndSwap
+		unsigned int stateChangeCount;
+		unsigned int elidedStateChangeCount;
 
 		map<int, TextLabel> textLabels;
 		IPhongShader* lighting;
@@ -48,9 +65,26 @@ namespace ginkgo
 		ScreenBuffer* renderSurface;
 		IText* textRenderer;
 		ILayer* renderLayer;
+		FrameCapture* frameCapture;
 		IWindow* window;
 		ICamera* camera;
 
+		TripleBuffer<RenderSnapshot> snapshots;
+		//copy of the snapshot before the one in snapshots' read slot, for interpolation
+		RenderSnapshot previousSnapshot;
+		//UID -> index into previousSnapshot.transforms, rebuilt once a tick
+		std::unordered_map<int, unsigned int> previousSlots;
+		//handed over by releaseRenderable, removed and deleted at the start of the next frame
+		std::mutex releasedMutex;
+		vector<IRenderable*> released;
+
+		void applySnapshot();
+		void deleteReleased();
+		void applyQuality();
+		void readFrameQuery();
+		void retainTextLabel(TextLabel& label);
+		void updateTextLabel(const TextLabel& label);
+
 	public:
 		Renderer(IWindow* window);
 
@@ -58,6 +92,7 @@ namespace ginkgo
 		void removeRenderable(int UID) override;
 		
 		IRenderable* getRenderable(int UID) const override;
+		unsigned int bakeStaticGeometry(const vector<int>& UIDs, float chunkSize) override;
 
 		void setDirectionalLight(const DirectionalLight& directionalLight) override;
 		void setAmbientLight(const vec4& ambientLight) override;
@@ -83,6 +118,27 @@ namespace ginkgo
 
 		ICamera* getCamera() override;
 
+		void setTargetFrameTime(double seconds) override;
+		void setAdaptiveQuality(bool enabled) override;
+		int getQualityLevel() const override { return governor.getLevel(); }
+		void setPostProcessing(bool enabled) override;
+
+		RenderSnapshot& beginSnapshot() override;
+		RenderSnapshot& getWriteSnapshot() override;
+		void publishSnapshot() override;
+		void releaseRenderable(IRenderable* renderable) override;
+
 		void renderAndSwap() override;
+
+		void screenshot(const string& path) override;
+		void startCapture(const string& path) override;
+		void stopCapture() override;
+		void finishCaptures() override;
+
+		unsigned int getDrawnCount() const override;
+		unsigned int getCulledCount() const override;
+		unsigned int getDrawCallCount() const override;
+		unsigned int getStateChangeCount() const override;
+		unsigned int getElidedStateChangeCount() const override;
 	};
 }
\ No newline at end of file
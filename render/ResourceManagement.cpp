@@ -2,28 +2,43 @@
 #include "Mesh.h"
 #include "ObjLoader.h"
 #include "Texture.h"
-#include "FileUtils.h"
+#include "MeshCache.h"
+#include "AssetLoader.h"
+#include "TexturePacker.h"
 
 namespace ginkgo
 {
 	static map<string, Mesh*> meshHash;
 	static map<string, Texture*> textureHash;
+	//created on first use, deliberately never destroyed by static teardown (threads can't be joined from there)
+	static AssetLoader* assetLoader = nullptr;
+
+	static AssetLoader* getAssetLoader()
+	{
+		if (assetLoader == nullptr)
+		{
+			//leave a core for the render thread
+			unsigned int cores = std::thread::hardware_concurrency();
+			assetLoader = new AssetLoader((cores > 1) ? cores - 1 : 1);
+		}
+		return assetLoader;
+	}
 
 
-	Mesh* createMesh(const vector<vec3>& positions, const vector<unsigned int>& indices, const vector<vec2>& uvs, string const& UID, const vector<vec3>& normals)
+	Mesh* createMesh(const vector<vec3>& positions, const vector<unsigned int>& indices, const vector<vec2>& uvs, string const& UID, const vector<vec3>& normals, VertexFormat format)
 	{
 		if (meshHash.find(UID) != meshHash.end())
 		{
 			//TODO: error handle
 			return nullptr;
 		}
-		Mesh* ret = new Mesh();
+		Mesh* ret = new Mesh(format);
 		ret->addData(positions, indices, uvs, normals);
 		meshHash[UID] = ret;
 		return ret;
 	}
 
-	Mesh* loadMesh(const string& path, const string& UID)
+	Mesh* loadMesh(const string& path, const string& UID, VertexFormat format)
 	{
 		try
 		{
@@ -33,8 +48,27 @@ namespace ginkgo
 				//TODO: error handle
 				return nullptr;
 			}
-			ObjLoader meshData(path);
-			return createMesh(meshData.getPositionList(), meshData.getIndexList(), meshData.getUVList(), UID, meshData.getNormalList());
+
+			//skip parsing the obj whenever the binary cache next to it is still current
+			string cachePath = MeshCache::getCachePath(path, format);
+			Mesh* ret = new Mesh(format);
+			if (!MeshCache::load(cachePath, path, *ret))
+			{
+				ObjLoadStats stats;
+				ObjLoader meshData(path, &stats);
+				ObjLoader::logStats(path, stats);
+				vector<GLfloat> vertices = Mesh::interleave(meshData.getPositionList(), meshData.getIndexList(), meshData.getUVList(), meshData.getNormalList());
+				const vector<unsigned int>& indices = meshData.getIndexList();
+				GLuint vertexCount = meshData.getPositionList().size();
+				const GLfloat* vertexData = vertices.empty() ? nullptr : &vertices[0];
+				//packed once, the cache then holds the blocks exactly as this format uploads them
+				PackedMesh packed;
+				Mesh::pack(format, vertexData, vertexCount, indices.empty() ? nullptr : &indices[0], indices.size(), Mesh::computeBounds(vertexData, vertexCount), packed);
+				ret->addPackedData(packed);
+				MeshCache::save(cachePath, path, packed);
+			}
+			meshHash[UID] = ret;
+			return ret;
 		}
 		catch (std::runtime_error e)
 		{
@@ -51,48 +85,85 @@ namespace ginkgo
 			return nullptr;
 		}
 
-		Texture* t = new Texture();
-		BYTE* pixels = FileUtils::loadImage(path.c_str(), &t->width, &t->height);
-		GLenum err;
-		err = glGetError();
-		if (err != GL_NO_ERROR)
+		Texture* t = TexturePacker::load(path, pixelate);
+		if (t == nullptr)
 		{
 			//TODO: error handle (return static checkerboard texture source engine style)
-			delete[] pixels;
 			return nullptr;
+		}
+		textureHash[UID] = t;
+		return t;
+	}
 
+	unsigned int createTextures(const vector<string>& paths, bool pixelate, const vector<string>& UIDs)
+	{
+		vector<string> packed;
+		vector<string> packedUIDs;
+		for (unsigned int i = 0; i < paths.size() && i < UIDs.size(); i++)
+		{
+			if (textureHash.find(UIDs[i]) == textureHash.end())
+			{
+				packed.push_back(paths[i]);
+				packedUIDs.push_back(UIDs[i]);
+			}
 		}
-		glGenTextures(1, &t->tid);
-		glBindTexture(GL_TEXTURE_2D, t->tid);
-		GLenum option = (pixelate) ? GL_NEAREST : GL_LINEAR;
-		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, option);
-		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, option);
-		GLint alignment;
-		
-		glGetIntegerv(GL_UNPACK_ALIGNMENT, &alignment);
-		if (t->width != t->height)
+
+		vector<Texture*> textures = TexturePacker::pack(packed, pixelate);
+		unsigned int count = 0;
+		for (unsigned int i = 0; i < textures.size(); i++)
 		{
-			glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+			if (textures[i] != nullptr)
+			{
+				textureHash[packedUIDs[i]] = textures[i];
+				count++;
+			}
 		}
-		glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB, t->width, t->height, 0, GL_BGR, GL_UNSIGNED_BYTE, pixels);
-		glPixelStorei(GL_UNPACK_ALIGNMENT, alignment);
-		err = glGetError();
-		glBindTexture(GL_TEXTURE_2D, 0);
-		if (err != GL_NO_ERROR)
+		return count;
+	}
+
+
+	MeshHandle loadMeshAsync(const string& path, const string& UID, VertexFormat format)
+	{
+		if (meshHash.find(UID) != meshHash.end())
 		{
-			//TODO: error handle (return static checkerboard texture source engine style)
-			delete[] pixels;
-			return nullptr;
+			//TODO: error handle
+			return MeshHandle();
 		}
-		t->filepath = path;
+		MeshHandle handle = getAssetLoader()->loadMesh(path, format);
+		meshHash[UID] = handle.get();
+		return handle;
+	}
 
-		delete[] pixels;
+	TextureHandle createTextureAsync(const string& path, bool pixelate, const string& UID)
+	{
+		if (textureHash.find(UID) != textureHash.end())
+		{
+			//TODO: error handle
+			return TextureHandle();
+		}
+		TextureHandle handle = getAssetLoader()->loadTexture(path, pixelate);
+		textureHash[UID] = handle.get();
+		return handle;
+	}
 
-		textureHash[UID] = t;
+	void uploadLoadedAssets(double budgetMilliseconds)
+	{
+		if (assetLoader != nullptr)
+		{
+			assetLoader->update(budgetMilliseconds);
+		}
+	}
 
-		return t;
+	unsigned int getLoadingAssetCount()
+	{
+		return (assetLoader != nullptr) ? assetLoader->getInFlightCount() : 0;
 	}
 
+	void shutdownAssetLoading()
+	{
+		delete assetLoader;
+		assetLoader = nullptr;
+	}
 
 	Mesh* retrieveMesh(const string& UID)
 	{
@@ -121,6 +192,10 @@ namespace ginkgo
 		}
 		Mesh* m = meshHash[UID];
 		meshHash.erase(pos);
+		if (assetLoader != nullptr)
+		{
+			assetLoader->cancel(m);
+		}
 		delete m;
 	}
 
@@ -133,6 +208,10 @@ namespace ginkgo
 		}
 		Texture* t = textureHash[UID];
 		textureHash.erase(pos);
+		if (assetLoader != nullptr)
+		{
+			assetLoader->cancel(t);
+		}
 		delete t;
 	}
 }
\ No newline at end of file
@@ -1,15 +1,30 @@
 #pragma once
 
 #include "RenderResource.h"
+#include "Mesh.h"
+#include "AssetHandle.h"
 
 namespace ginkgo
 {
-	class Mesh;
 	struct Texture;
 
-	DECLSPEC_RENDER Mesh* createMesh(const vector<vec3>& positions, const vector<unsigned int>& indices, const vector<vec2>& uvs, string const& UID, const vector<vec3>& normals = vector<vec3>());
-	DECLSPEC_RENDER Mesh* loadMesh(const string& path, string const& UID);
+	//quantized formats halve vertex memory, VERTEX_FLOAT keeps full precision positions
+	DECLSPEC_RENDER Mesh* createMesh(const vector<vec3>& positions, const vector<unsigned int>& indices, const vector<vec2>& uvs, string const& UID, const vector<vec3>& normals = vector<vec3>(), VertexFormat format = VERTEX_SNORM16);
+	DECLSPEC_RENDER Mesh* loadMesh(const string& path, string const& UID, VertexFormat format = VERTEX_SNORM16);
 	DECLSPEC_RENDER Texture* createTexture(const string& path, bool pixelate, const string& UID);
+	//loads the images into as few texture arrays as it can (same sized images share one, small ones are atlased)
+	//so materials using them draw without rebinding textures, returns how many loaded
+	DECLSPEC_RENDER unsigned int createTextures(const vector<string>& paths, bool pixelate, const vector<string>& UIDs);
+
+	//asynchronous versions, decoded on worker threads and uploaded a little each frame by the renderer
+	//the returned asset is usable (as a placeholder) straight away and retrievable by UID like any other
+	DECLSPEC_RENDER MeshHandle loadMeshAsync(const string& path, const string& UID, VertexFormat format = VERTEX_SNORM16);
+	DECLSPEC_RENDER TextureHandle createTextureAsync(const string& path, bool pixelate, const string& UID);
+	//render thread, called by the renderer once a frame
+	DECLSPEC_RENDER void uploadLoadedAssets(double budgetMilliseconds);
+	DECLSPEC_RENDER unsigned int getLoadingAssetCount();
+	//joins the loader threads, call before the GL context goes away
+	DECLSPEC_RENDER void shutdownAssetLoading();
 
 	DECLSPEC_RENDER Mesh* retrieveMesh(const string& UID);
 	DECLSPEC_RENDER Texture* retrieveTexture(const string& UID);
@@ -3,11 +3,12 @@
 #include <iostream>
 
 #include "ScreenBuffer.h"
+#include "GLState.h"
 
 namespace ginkgo {
 
 	ScreenBuffer::ScreenBuffer(unsigned int width, unsigned int height, vec4 clear_color, bool depth, bool stencil)
-		: clear_color(clear_color)
+		: clear_color(clear_color), width(width), height(height), renderScale(1.0f), postProcessing(false)
 	{
 		addVertexShader("shaders/screenVertex.vs");
 		addFragmentShader("shaders/screenFragment.fs");
@@ -26,19 +27,19 @@ namespace ginkgo {
 
 		glGenVertexArrays(1, &quadVAO);
 		glGenBuffers(1, &quadVBO);
-		glBindVertexArray(quadVAO);
-		glBindBuffer(GL_ARRAY_BUFFER, quadVBO);
+		GLState::bindVertexArray(quadVAO);
+		GLState::bindBuffer(GL_ARRAY_BUFFER, quadVBO);
 		glBufferData(GL_ARRAY_BUFFER, sizeof(quadVertices), &quadVertices, GL_STATIC_DRAW);
 		glEnableVertexAttribArray(0);
 		glEnableVertexAttribArray(1);
 		glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, 4 * sizeof(GLfloat), (GLvoid*)0);
 		glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, 4 * sizeof(GLfloat), (GLvoid*)(2 * sizeof(GLfloat)));
-		glBindBuffer(GL_ARRAY_BUFFER, 0);
-		glBindVertexArray(0);
+		GLState::bindBuffer(GL_ARRAY_BUFFER, 0);
+		GLState::bindVertexArray(0);
 
 
 		glGenFramebuffers(1, &FBO);
-		glBindFramebuffer(GL_FRAMEBUFFER, FBO);
+		GLState::bindFramebuffer(FBO);
 
 		GLenum attachment_type;
 		if (!depth && !stencil)
@@ -49,14 +50,14 @@ namespace ginkgo {
 			attachment_type = GL_STENCIL_INDEX;
 
 		glGenTextures(1, &textureID);
-		glBindTexture(GL_TEXTURE_2D, textureID);
+		GLState::bindTexture(GL_TEXTURE_2D, textureID);
 		if (!depth && !stencil)
 			glTexImage2D(GL_TEXTURE_2D, 0, attachment_type, width, height, 0, attachment_type, GL_UNSIGNED_BYTE, NULL);
 		else
 			glTexImage2D(GL_TEXTURE_2D, 0, GL_DEPTH24_STENCIL8, width, height, 0, GL_DEPTH_STENCIL, GL_UNSIGNED_BYTE, NULL);
 		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
 		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-		glBindTexture(GL_TEXTURE_2D, 0);
+		GLState::bindTexture(GL_TEXTURE_2D, 0);
 
 		glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, textureID, 0);
 
@@ -69,26 +70,33 @@ namespace ginkgo {
 
 		if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE)
 			std::cout << "ERROR::FRAMEBUFFER:: Framebuffer is not complete!" << std::endl;
-		glBindFramebuffer(GL_FRAMEBUFFER, 0);
+		GLState::bindFramebuffer(0);
 	}
 
 	ScreenBuffer::~ScreenBuffer()
 	{
 		glDeleteRenderbuffers(1, &RBO);
-		glDeleteFramebuffers(1, &FBO);
-		glDeleteTextures(1, &textureID);
-		glDeleteBuffers(1, &quadVBO);
-		glDeleteVertexArrays(1, &quadVAO);
+		GLState::deleteFramebuffers(1, &FBO);
+		GLState::deleteTextures(1, &textureID);
+		GLState::deleteBuffers(1, &quadVBO);
+		GLState::deleteVertexArrays(1, &quadVAO);
+	}
+
+	void ScreenBuffer::linked()
+	{
+		bind();
+		setUniform2f("uvScale", vec2(1.0f, 1.0f));
+		unbind();
 	}
 
 	void ScreenBuffer::bindBuffer() const
 	{
-		glBindFramebuffer(GL_FRAMEBUFFER, FBO);
+		GLState::bindFramebuffer(FBO);
 	}
 
 	void ScreenBuffer::bindDefaultBuffer()
 	{
-		glBindFramebuffer(GL_FRAMEBUFFER, 0);
+		GLState::bindFramebuffer(0);
 	}
 
 	void ScreenBuffer::clearColor(const vec4& clear_color)
@@ -116,9 +124,23 @@ namespace ginkgo {
 		ScreenBuffer::enableDepthTest();
 	}
 
+	void ScreenBuffer::setRenderScale(float scale)
+	{
+		renderScale = glm::clamp(scale, 0.25f, 1.0f);
+	}
+
 	void ScreenBuffer::drawToTexture() const
 	{
-		bindBuffer();
+		if (isDirect())
+		{
+			ScreenBuffer::bindDefaultBuffer();
+			glViewport(0, 0, width, height);
+		}
+		else
+		{
+			bindBuffer();
+			glViewport(0, 0, getScaledWidth(), getScaledHeight());
+		}
 		ScreenBuffer::initalize(clear_color);
 		//glBlendFuncSeparate(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA, GL_ONE, GL_ONE_MINUS_SRC_ALPHA);
 	}
@@ -126,18 +148,22 @@ namespace ginkgo {
 	void ScreenBuffer::drawToScreen() const
 	{
 		ScreenBuffer::bindDefaultBuffer();
+		glViewport(0, 0, width, height);
+		//whatever draws next (text) goes over the scene, not into its depth
+		GLState::disable(GL_DEPTH_TEST);
+		if (isDirect())
+		{
+			return;
+		}
 		ScreenBuffer::clearColor(clear_color);
 		ScreenBuffer::clearBuffer(true, false, false);
 		
 		bind();
+		setUniform2f("uvScale", vec2(getScaledWidth() / (float)width, getScaledHeight() / (float)height));
 
-		glBindVertexArray(quadVAO);
-		glDisable(GL_DEPTH_TEST);
-		glBindTexture(GL_TEXTURE_2D, textureID);
+		GLState::bindVertexArray(quadVAO);
+		GLState::bindTexture(0, GL_TEXTURE_2D, textureID);
 		glDrawArrays(GL_TRIANGLES, 0, 6);
-		glBindVertexArray(0);
-
-		unbind();
 	}
 
 }
\ No newline at end of file
@@ -1,6 +1,7 @@
 #pragma once
 
 #include "Shader.h"
+#include "GLState.h"
 #include <GL/glew.h>
 #include <glm/glm.hpp>
 
@@ -16,10 +17,27 @@ namespace ginkgo {
 		GLuint quadVAO; //rectangle
 		GLuint quadVBO; //rectangle
 		vec4 clear_color;
+		GLsizei width, height; //of the window, and of the texture
+		float renderScale;
+		bool postProcessing;
+
+		GLsizei getScaledWidth() const { return glm::max(1, (GLsizei)(width * renderScale)); }
+		GLsizei getScaledHeight() const { return glm::max(1, (GLsizei)(height * renderScale)); }
+		//nothing for the screen pass to do, the scene goes straight to the window
+		bool isDirect() const { return !postProcessing && renderScale >= 1.0f; }
+
+		void linked() override;
 	public:
 		ScreenBuffer(unsigned int screenWidth, unsigned int screenHeight, vec4 clear_color, bool depth, bool stencil);
 		~ScreenBuffer();
 
+		//the scene renders into the bottom left renderScale of the texture and is stretched over the window by drawToScreen
+		void setRenderScale(float scale);
+		float getRenderScale() const { return renderScale; }
+		//off with full scale, drawToTexture draws to the window itself and drawToScreen has nothing to copy
+		void setPostProcessing(bool enabled) { postProcessing = enabled; }
+		bool isPostProcessing() const { return postProcessing; }
+
 		void drawToTexture() const;
 		void drawToScreen() const;
 		static void initalize(const vec4& clearColor = vec4(0, 0, 0, 0));
@@ -30,10 +48,10 @@ namespace ginkgo {
 		static void clearColor(const vec4& clear_color);
 		static void clearBuffer(bool colorBuffer, bool depthBuffer, bool stencilBuffer);
 		
-		static void enableDepthTest() { glEnable(GL_DEPTH_TEST); }
-		static void enableStencilTest() { glEnable(GL_STENCIL_TEST); }
-		static void disableDepthTest() { glDisable(GL_DEPTH_TEST); }
-		static void disableStencilTest() { glDisable(GL_STENCIL_TEST); }
+		static void enableDepthTest() { GLState::enable(GL_DEPTH_TEST); }
+		static void enableStencilTest() { GLState::enable(GL_STENCIL_TEST); }
+		static void disableDepthTest() { GLState::disable(GL_DEPTH_TEST); }
+		static void disableStencilTest() { GLState::disable(GL_STENCIL_TEST); }
 		
 		static void drawAsWireframe() { glPolygonMode(GL_FRONT_AND_BACK, GL_LINE); }
 		static void drawAsPoints() { glPolygonMode(GL_FRONT_AND_BACK, GL_POINT); }
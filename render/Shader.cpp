@@ -1,20 +1,34 @@
 #include <iostream>
+#include <algorithm>
 
 #include "Shader.h"
 
 #include "FileUtils.h"
+#include "ProgramCache.h"
+#include "GLState.h"
 
 
 namespace ginkgo {
 
+	vector<Shader*> Shader::pendingShaders;
+
 	Shader::Shader()
+		: pending(false), cacheKey(0)
 	{
 		program = glCreateProgram();
 	}
 
 	Shader::~Shader()
 	{
-		glDeleteProgram(program);
+		if (pending)
+		{
+			pendingShaders.erase(std::find(pendingShaders.begin(), pendingShaders.end(), this));
+			for (unsigned int i = 0; i < compiling.size(); i++)
+			{
+				glDeleteShader(compiling[i]);
+			}
+		}
+		GLState::deleteProgram(program);
 	}
 
 	void Shader::addVertexShader(const char* file)
@@ -34,72 +48,182 @@ namespace ginkgo {
 
 	void Shader::addProgram(const char* file, GLenum type)
 	{
-		GLuint shaderID = glCreateShader(type);
+		types.push_back(type);
+		sources.push_back(FileUtils::read_file(file));
+		sourcePaths.push_back(file);
+	}
 
-		string shaderSourceString = FileUtils::read_file(file);
-		const char* shaderSource = shaderSourceString.c_str();
+	void Shader::submitSources()
+	{
+		ProgramCache::enableParallelCompile();
 
-		if (shaderID == 0)
+		//nothing here asks for a status, with parallel compile the driver works on every stage of every submitted program at once
+		for (unsigned int i = 0; i < sources.size(); i++)
 		{
-			std::cout << "Shader creation failed: Could not find valid memory location when adding shader" << std::endl;
-			system("pause");
-			return;
+			GLuint shaderID = glCreateShader(types[i]);
+			if (shaderID == 0)
+			{
+				std::cout << "Shader creation failed: Could not find valid memory location when adding shader" << std::endl;
+				continue;
+			}
+			const char* shaderSource = sources[i].c_str();
+			glShaderSource(shaderID, 1, &shaderSource, NULL);
+			glCompileShader(shaderID);
+			glAttachShader(program, shaderID);
+			compiling.push_back(shaderID);
 		}
 
-		glShaderSource(shaderID, 1, &shaderSource, NULL);
-		glCompileShader(shaderID);
-
-		GLint result;
-		glGetShaderiv(shaderID, GL_COMPILE_STATUS, &result);
-		if (result == GL_FALSE)
+		if (ProgramCache::isSupported())
 		{
-			GLint length;
-			glGetShaderiv(shaderID, GL_INFO_LOG_LENGTH, &length);
-			vector<char> error(length);
-			glGetShaderInfoLog(shaderID, length, &length, &error[0]);
-			std::cout << "Failed to compile shader!/tType of Shader: " << type << std::endl << &error[0] << std::endl;
-			glDeleteShader(shaderID);
-			system("pause");
-			return;
+			glProgramParameteri(program, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
 		}
-
-		glAttachShader(program, shaderID);
-		shaders.push_back(shaderID);
+		glLinkProgram(program);
 	}
-	
-	void Shader::compileShader() const
+
+	bool Shader::checkSources()
 	{
-		glLinkProgram(program);
+		bool compiled = compiling.size() == sourcePaths.size();
+		for (unsigned int i = 0; i < compiling.size(); i++)
+		{
+			GLint result;
+			glGetShaderiv(compiling[i], GL_COMPILE_STATUS, &result);
+			if (result == GL_FALSE)
+			{
+				GLint length;
+				glGetShaderiv(compiling[i], GL_INFO_LOG_LENGTH, &length);
+				vector<char> error(length + 1);
+				glGetShaderInfoLog(compiling[i], length, &length, &error[0]);
+				std::cout << "Failed to compile shader!/tFile: " << sourcePaths[i] << std::endl << &error[0] << std::endl;
+				compiled = false;
+			}
+		}
 
 		GLint success; GLchar infoLog[512];
 		glGetProgramiv(program, GL_LINK_STATUS, &success);
-		if (!success)
+		if (compiled && !success)
 		{
 			glGetProgramInfoLog(program, 512, NULL, infoLog);
 			std::cout << "ERROR::SHADER::PROGRAM::LINKING_FAILED/n" << infoLog << std::endl;
-			system("PAUSE");
 		}
 
-		glValidateProgram(program);
+		for (unsigned int i = 0; i < compiling.size(); i++)
+		{
+			glDetachShader(program, compiling[i]);
+			glDeleteShader(compiling[i]);
+		}
+		compiling.clear();
+		return compiled && success;
+	}
+	
+	void Shader::compileShader()
+	{
+		//a driver-compiled binary from an earlier run skips compiling and linking entirely
+		cacheKey = ProgramCache::makeKey(sources);
+		if (!ProgramCache::load(program, ProgramCache::getCachePath(sourcePaths), cacheKey))
+		{
+			submitSources();
+		}
+		sources.clear();
+		pending = true;
+		pendingShaders.push_back(this);
+	}
 
-		for (unsigned int i = 0; i < shaders.size(); i++)
-			glDeleteShader(shaders[i]);
+	void Shader::finishCompiles()
+	{
+		while (!pendingShaders.empty())
+		{
+			//whichever the driver has done first, the oldest (waiting on it) if none are
+			unsigned int next = 0;
+			if (GLEW_ARB_parallel_shader_compile)
+			{
+				for (unsigned int i = 0; i < pendingShaders.size(); i++)
+				{
+					GLint done = GL_FALSE;
+					glGetProgramiv(pendingShaders[i]->program, GL_COMPLETION_STATUS_ARB, &done);
+					if (done == GL_TRUE)
+					{
+						next = i;
+						break;
+					}
+				}
+			}
+			Shader* shader = pendingShaders[next];
+			pendingShaders.erase(pendingShaders.begin() + next);
+			shader->finishCompile();
+		}
+	}
+
+	void Shader::finishCompile()
+	{
+		pending = false;
+		//nothing was submitted on a cache hit, the cache already checked the link
+		if (!compiling.empty() && checkSources())
+		{
+			ProgramCache::save(program, ProgramCache::getCachePath(sourcePaths), cacheKey);
+		}
+
+		//look everything up now so nothing has to ask the driver by name while drawing
+		uniformLocations.clear();
+		GLint uniformCount = 0, maxLength = 0;
+		glGetProgramiv(program, GL_ACTIVE_UNIFORMS, &uniformCount);
+		glGetProgramiv(program, GL_ACTIVE_UNIFORM_MAX_LENGTH, &maxLength);
+		vector<GLchar> name(maxLength + 1);
+		for (GLint i = 0; i < uniformCount; i++)
+		{
+			GLint size;
+			GLenum type;
+			glGetActiveUniform(program, i, (GLsizei)name.size(), NULL, &size, &type, &name[0]);
+			GLint location = glGetUniformLocation(program, &name[0]);
+			if (location < 0)
+			{
+				continue; //inside a uniform block
+			}
+			string uniformName(&name[0]);
+			uniformLocations[uniformName] = location;
+			//arrays are reported as name[0], also allow the bare name
+			if (uniformName.size() > 3 && uniformName.compare(uniformName.size() - 3, 3, "[0]") == 0)
+			{
+				uniformLocations[uniformName.substr(0, uniformName.size() - 3)] = location;
+			}
+		}
+
+		linked();
+	}
+
+	void Shader::cacheUniformIDs(const char* const* names, int count)
+	{
+		uniformIDs.resize(count);
+		for (int i = 0; i < count; i++)
+		{
+			uniformIDs[i] = getUniformLocation(names[i]);
+		}
 	}
 
 
 	void Shader::bind() const
 	{
-		glUseProgram(program);
+		if (pending)
+		{
+			//first use, the programs submitted alongside this one are most likely done too
+			finishCompiles();
+		}
+		GLState::useProgram(program);
 	}
 
 	void Shader::unbind() const
 	{
-		glUseProgram(0);
+		GLState::useProgram(0);
 	}
 
 	GLint Shader::getUniformLocation(const GLchar* name) const
 	{
-		return glGetUniformLocation(program, name);
+		auto location = uniformLocations.find(name);
+		if (location == uniformLocations.end())
+		{
+			//not active (optimized out), same as what gl would hand back
+			return -1;
+		}
+		return location->second;
 	}
 
 	void Shader::setUniform1f(const GLchar* name, float value) const
@@ -141,4 +265,29 @@ namespace ginkgo {
 		glUniformMatrix4fv(getUniformLocation(name), 1, GL_FALSE, &matrix[0][0]);
 	}
 
+	void Shader::setUniform1f(int uniformID, float value) const
+	{
+		glUniform1f(getUniformLocation(uniformID), value);
+	}
+
+	void Shader::setUniform1i(int uniformID, int value) const
+	{
+		glUniform1i(getUniformLocation(uniformID), value);
+	}
+
+	void Shader::setUniform3f(int uniformID, const vec3& vector) const
+	{
+		glUniform3f(getUniformLocation(uniformID), vector.x, vector.y, vector.z);
+	}
+
+	void Shader::setUniform4f(int uniformID, const vec4& vector) const
+	{
+		glUniform4f(getUniformLocation(uniformID), vector.x, vector.y, vector.z, vector.w);
+	}
+
+	void Shader::setUniformMat4(int uniformID, const mat4& matrix) const
+	{
+		glUniformMatrix4fv(getUniformLocation(uniformID), 1, GL_FALSE, &matrix[0][0]);
+	}
+
 }
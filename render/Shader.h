@@ -4,6 +4,8 @@
 #include "RenderResource.h"
 #include <GL/glew.h>
 #include <glm/glm.hpp>
+#include <unordered_map>
+#include <cstdint>
 
 namespace ginkgo {
 
@@ -11,16 +13,33 @@ namespace ginkgo {
 	{
 	private:
 		GLuint program;
-		vector<GLuint> shaders;
+		//added stages, compiled together by compileShader unless the program cache has the result
+		vector<GLenum> types;
+		vector<string> sources;
+		vector<string> sourcePaths;
+		//between compileShader and finishing: the submitted stages (none on a cache hit) and the cache key to save under
+		bool pending;
+		vector<GLuint> compiling;
+		uint64_t cacheKey;
+		//every program submitted but not finished yet, oldest first
+		static vector<Shader*> pendingShaders;
+		//every active uniform's location, filled in once the program links
+		std::unordered_map<string, GLint> uniformLocations;
+		//locations for cacheUniformIDs, indexed by the subclass's own uniform enum
+		vector<GLint> uniformIDs;
 	public:
 		Shader();
-		~Shader();
+		virtual ~Shader();
 
 		void addVertexShader(const char* filepath);
 		void addGeometryShader(const char* filepath);
 		void addFragmentShader(const char* filepath);
 		void addProgram(const char* filepath, GLenum type);
-		void compileShader() const;
+		//submits the stages and returns without asking for any status, so the driver compiles this program while the next ones are submitted
+		//the program is checked and set up (linked) on its first bind, or by finishCompiles
+		void compileShader();
+		//finishes every submitted program, each one as soon as the driver reports it done (GL_COMPLETION_STATUS_ARB)
+		static void finishCompiles();
 
 
 		void setUniform1f(const GLchar* name, float value) const;
@@ -31,11 +50,28 @@ namespace ginkgo {
 		void setUniform3f(const GLchar* name, const vec3& vector) const;
 		void setUniform4f(const GLchar* name, const vec4& vector) const;
 		void setUniformMat4(const GLchar* name, const mat4& matrix) const;
+
+		void setUniform1f(int uniformID, float value) const;
+		void setUniform1i(int uniformID, int value) const;
+		void setUniform3f(int uniformID, const vec3& vector) const;
+		void setUniform4f(int uniformID, const vec4& vector) const;
+		void setUniformMat4(int uniformID, const mat4& matrix) const;
 		
 		void bind() const;
 		void unbind() const;
+	protected:
+		GLuint getProgram() const { return program; }
+		//resolve names[i] to uniform ID i, call from linked
+		void cacheUniformIDs(const char* const* names, int count);
+		//once the program has linked, before anything uses it, for uniform defaults and block bindings
+		virtual void linked() {}
 	private:
+		void submitSources();
+		//compile and link results, waits for them if the driver isn't done
+		bool checkSources();
+		void finishCompile();
 		GLint getUniformLocation(const GLchar* name) const;
+		GLint getUniformLocation(int uniformID) const { return uniformIDs[uniformID]; }
 
 	};
 
@@ -0,0 +1,103 @@
+#include "StaticGeometry.h"
+
+#include "IRenderable.h"
+#include "Renderable.h"
+#include "Material.h"
+#include "Mesh.h"
+#include <glm/gtc/matrix_inverse.hpp>
+#include <cmath>
+
+namespace ginkgo {
+
+	namespace
+	{
+		struct ChunkBuilder
+		{
+			const Material* material;
+			int cellX, cellY, cellZ;
+			vector<GLfloat> vertices;
+			vector<GLuint> indices;
+		};
+	}
+
+	StaticGeometry::StaticGeometry(const vector<const IRenderable*>& sources, float chunkSize)
+	{
+		vector<ChunkBuilder> builders;
+		vector<GLfloat> vertices;
+		vector<GLuint> indices;
+
+		for (unsigned int s = 0; s < sources.size(); s++)
+		{
+			const IRenderable* source = sources[s];
+			const mat4& model = source->getModel();
+			glm::mat3 normalMatrix = glm::inverseTranspose(glm::mat3(model));
+
+			//a whole source goes to the chunk its bounding sphere center falls in
+			vec3 center = vec3(model * vec4(source->getMesh().getBoundingSphereCenter(), 1.0f));
+			int cellX = (int)std::floor(center.x / chunkSize);
+			int cellY = (int)std::floor(center.y / chunkSize);
+			int cellZ = (int)std::floor(center.z / chunkSize);
+
+			ChunkBuilder* builder = nullptr;
+			for (unsigned int b = 0; b < builders.size(); b++)
+			{
+				if (builders[b].cellX == cellX && builders[b].cellY == cellY && builders[b].cellZ == cellZ &&
+					builders[b].material->isEquivalent(source->getMaterial()))
+				{
+					builder = &builders[b];
+					break;
+				}
+			}
+			if (builder == nullptr)
+			{
+				builders.emplace_back();
+				builder = &builders.back();
+				builder->material = &source->getMaterial();
+				builder->cellX = cellX;
+				builder->cellY = cellY;
+				builder->cellZ = cellZ;
+			}
+
+			source->getMesh().readBack(vertices, indices);
+
+			GLuint base = builder->vertices.size() / Mesh::VERTEX_STRIDE;
+			for (unsigned int v = 0; v < vertices.size(); v += Mesh::VERTEX_STRIDE)
+			{
+				vec3 position = vec3(model * vec4(vertices[v + 0], vertices[v + 1], vertices[v + 2], 1.0f));
+				vec3 normal = glm::normalize(normalMatrix * vec3(vertices[v + 5], vertices[v + 6], vertices[v + 7]));
+				GLfloat out[Mesh::VERTEX_STRIDE] = { position.x, position.y, position.z, vertices[v + 3], vertices[v + 4], normal.x, normal.y, normal.z };
+				builder->vertices.insert(builder->vertices.end(), out, out + Mesh::VERTEX_STRIDE);
+			}
+			for (unsigned int i = 0; i < indices.size(); i++)
+			{
+				builder->indices.push_back(base + indices[i]);
+			}
+		}
+
+		for (unsigned int b = 0; b < builders.size(); b++)
+		{
+			if (builders[b].indices.empty())
+			{
+				continue;
+			}
+			Mesh* mesh = new Mesh();
+			mesh->addInterleavedData(&builders[b].vertices[0], builders[b].vertices.size() / Mesh::VERTEX_STRIDE, &builders[b].indices[0], builders[b].indices.size());
+			meshes.push_back(mesh);
+			//renderables own their material
+			chunks.push_back(new Renderable(mesh, new Material(*builders[b].material)));
+		}
+	}
+
+	StaticGeometry::~StaticGeometry()
+	{
+		for (unsigned int i = 0; i < chunks.size(); i++)
+		{
+			delete chunks[i];
+		}
+		for (unsigned int i = 0; i < meshes.size(); i++)
+		{
+			delete meshes[i];
+		}
+	}
+
+}
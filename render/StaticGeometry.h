@@ -0,0 +1,26 @@
+#pragma once
+
+#include "RenderResource.h"
+
+namespace ginkgo {
+
+	class IRenderable;
+	class Mesh;
+
+	//level geometry that never moves, pre-transformed and merged per material and per spatial chunk
+	//each chunk is an ordinary renderable with an identity model, so culling and sorting treat it like any other
+	class StaticGeometry
+	{
+	private:
+		vector<Mesh*> meshes;
+		vector<IRenderable*> chunks;
+
+	public:
+		//sources are only read, the caller keeps ownership of them
+		StaticGeometry(const vector<const IRenderable*>& sources, float chunkSize);
+		~StaticGeometry();
+
+		const vector<IRenderable*>& getChunks() const { return chunks; }
+	};
+
+}
@@ -0,0 +1,162 @@
+#include <iostream>
+
+#include "StreamBuffer.h"
+#include "GLState.h"
+
+namespace ginkgo {
+
+	namespace
+	{
+		const GLbitfield PERSISTENT_FLAGS = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+	}
+
+	bool StreamBuffer::isSupported()
+	{
+		return GLEW_ARB_buffer_storage != 0;
+	}
+
+	StreamBuffer::StreamBuffer(GLsizeiptr sectionSize)
+		: buffer(0), sectionSize(0), persistent(isSupported()), mapped(nullptr), section(0), head(0), flushed(0)
+	{
+		for (unsigned int i = 0; i < FRAMES_IN_FLIGHT; i++)
+		{
+			fences[i] = 0;
+		}
+		create(sectionSize);
+	}
+
+	StreamBuffer::~StreamBuffer()
+	{
+		destroy();
+	}
+
+	void StreamBuffer::create(GLsizeiptr size)
+	{
+		sectionSize = size;
+		glGenBuffers(1, &buffer);
+		//the copy target so creating one never disturbs a vertex array or uniform binding
+		GLState::bindBuffer(GL_COPY_WRITE_BUFFER, buffer);
+		if (persistent)
+		{
+			glBufferStorage(GL_COPY_WRITE_BUFFER, sectionSize * FRAMES_IN_FLIGHT, NULL, PERSISTENT_FLAGS);
+			mapped = (unsigned char*)glMapBufferRange(GL_COPY_WRITE_BUFFER, 0, sectionSize * FRAMES_IN_FLIGHT, PERSISTENT_FLAGS);
+			if (mapped == nullptr)
+			{
+				//driver advertises buffer storage but won't map it, logged once for all the stream buffers
+				static bool reported = false;
+				if (!reported)
+				{
+					std::cout << "Failed to persistently map a stream buffer, streaming through glBufferSubData instead!" << std::endl;
+					reported = true;
+				}
+				GLState::deleteBuffers(1, &buffer);
+				persistent = false;
+				create(size);
+				return;
+			}
+		}
+		else
+		{
+			glBufferData(GL_COPY_WRITE_BUFFER, sectionSize, NULL, GL_STREAM_DRAW);
+			staging.resize(sectionSize);
+		}
+	}
+
+	void StreamBuffer::destroy()
+	{
+		for (unsigned int i = 0; i < FRAMES_IN_FLIGHT; i++)
+		{
+			if (fences[i] != 0)
+			{
+				glDeleteSync(fences[i]);
+				fences[i] = 0;
+			}
+		}
+		if (mapped != nullptr)
+		{
+			GLState::bindBuffer(GL_COPY_WRITE_BUFFER, buffer);
+			glUnmapBuffer(GL_COPY_WRITE_BUFFER);
+			mapped = nullptr;
+		}
+		//gl keeps the storage alive for draws already issued from it
+		GLState::deleteBuffers(1, &buffer);
+		buffer = 0;
+	}
+
+	void StreamBuffer::beginFrame()
+	{
+		section = (section + 1) % FRAMES_IN_FLIGHT;
+		head = 0;
+		flushed = 0;
+		GLsync& fence = fences[section];
+		if (fence != 0)
+		{
+			//flushing so the fence is sure to be signalled eventually, then wait in 1ms steps
+			GLenum result = glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, 0);
+			while (result == GL_TIMEOUT_EXPIRED)
+			{
+				result = glClientWaitSync(fence, 0, 1000000);
+			}
+			glDeleteSync(fence);
+			fence = 0;
+		}
+	}
+
+	void* StreamBuffer::allocate(GLsizeiptr size, GLsizeiptr alignment, GLintptr& offset)
+	{
+		//aligned from the start of the buffer, not the section
+		GLintptr base = getSectionOffset();
+		GLsizeiptr start = (alignment > 1) ? (base + head + alignment - 1) / alignment * alignment - base : head;
+		if (start + size > sectionSize)
+		{
+			GLsizeiptr grown = sectionSize * 2;
+			while (grown < start + size)
+			{
+				grown *= 2;
+			}
+			if (persistent)
+			{
+				//nothing in the new buffer is in flight, its fences start out empty
+				destroy();
+				create(grown);
+				section = 0;
+				start = 0;
+			}
+			else
+			{
+				//staging keeps what was written, the next flush orphans at the new size and uploads all of it
+				sectionSize = grown;
+				staging.resize(sectionSize);
+				flushed = 0;
+			}
+		}
+		head = start + size;
+		offset = getSectionOffset() + start;
+		return (persistent) ? mapped + offset : &staging[start];
+	}
+
+	void StreamBuffer::flush()
+	{
+		if (persistent || head == flushed)
+		{
+			return;
+		}
+		GLState::bindBuffer(GL_COPY_WRITE_BUFFER, buffer);
+		if (flushed == 0)
+		{
+			//orphaned, the storage the last draws read from is left to them
+			glBufferData(GL_COPY_WRITE_BUFFER, sectionSize, NULL, GL_STREAM_DRAW);
+		}
+		glBufferSubData(GL_COPY_WRITE_BUFFER, flushed, head - flushed, &staging[flushed]);
+		flushed = head;
+	}
+
+	void StreamBuffer::endFrame()
+	{
+		if (persistent && head > 0)
+		{
+			fences[section] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+		}
+	}
+
+}
@@ -0,0 +1,55 @@
+#pragma once
+
+#include "RenderResource.h"
+#include <GL/glew.h>
+
+namespace ginkgo {
+
+	//ring of per frame sections for data written by the cpu once and drawn from once
+	//with ARB_buffer_storage the buffer stays mapped (persistent, coherent) and allocations are written in place,
+	//a fence per section keeps the cpu from overwriting what a frame still in flight reads
+	//without it allocations go to a staging copy that flush uploads into a freshly orphaned buffer
+	//usage per frame: beginFrame, allocate + write, flush, draw from getBuffer() at the offsets, endFrame
+	class StreamBuffer
+	{
+	public:
+		static const unsigned int FRAMES_IN_FLIGHT = 3;
+	private:
+		GLuint buffer;
+		GLsizeiptr sectionSize;
+		bool persistent;
+		unsigned char* mapped; //whole buffer, persistent only
+		vector<unsigned char> staging; //one section, fallback only
+		GLsync fences[FRAMES_IN_FLIGHT];
+		unsigned int section;
+		GLsizeiptr head; //bytes used in the current section
+		GLsizeiptr flushed; //fallback: bytes of the current section already uploaded
+
+		StreamBuffer(const StreamBuffer&) = delete;
+		StreamBuffer& operator=(const StreamBuffer&) = delete;
+
+		void create(GLsizeiptr sectionSize);
+		void destroy();
+		GLintptr getSectionOffset() const { return (persistent) ? section * sectionSize : 0; }
+	public:
+		StreamBuffer(GLsizeiptr sectionSize);
+		~StreamBuffer();
+
+		//waits for the gpu to finish with the section this frame reuses, usually long done
+		void beginFrame();
+		//size bytes to write (never read, the memory may be write combined), offset is from the start of getBuffer()
+		//alignment needn't be a power of two, so a vertex size works for glDrawArrays' first
+		//a frame that outgrows its section moves to a new buffer twice the size, so call getBuffer() after allocating
+		//anything allocated earlier that frame but not drawn yet is lost with the old buffer, allocate once per frame where possible
+		void* allocate(GLsizeiptr size, GLsizeiptr alignment, GLintptr& offset);
+		//makes everything allocated so far visible to gl, call before drawing from it
+		void flush();
+		void endFrame();
+
+		GLuint getBuffer() const { return buffer; }
+		bool isPersistent() const { return persistent; }
+
+		static bool isSupported();
+	};
+
+}
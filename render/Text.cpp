@@ -1,137 +1,292 @@
 #include <iostream>
+#include <limits>
+#include <cstddef>
+#include <algorithm>
+#include <cstring>
 
 #include <glm/gtc/matrix_transform.hpp>
 
 #include "Text.h"
+#include "GLState.h"
 
 namespace ginkgo {
 
+	namespace
+	{
+		const GLsizei VERTICES_PER_GLYPH = 6;
+		//a frame's section of the stream, a few hundred glyphs
+		const GLsizeiptr INITIAL_VERTICES = 256 * VERTICES_PER_GLYPH;
+
+		//next code point, invalid bytes come out as themselves so nothing is skipped
+		unsigned int decodeUTF8(const string& text, unsigned int& i)
+		{
+			unsigned char lead = text[i++];
+			int continuation = (lead >= 0xF0) ? 3 : (lead >= 0xE0) ? 2 : (lead >= 0xC0) ? 1 : 0;
+			unsigned int codePoint = (continuation == 0) ? lead : lead & (0x3F >> continuation);
+			for (int c = 0; c < continuation; c++)
+			{
+				if (i >= text.size() || ((unsigned char)text[i] & 0xC0) != 0x80)
+				{
+					return lead;
+				}
+				codePoint = (codePoint << 6) | ((unsigned char)text[i++] & 0x3F);
+			}
+			return codePoint;
+		}
+	}
+
 	Text::Text(float windowWidth, float windowHeight, const char* fontFilePath, unsigned int fontSize)
+		: stream(INITIAL_VERTICES * sizeof(GlyphVertex)), streamedBuffer(0), atlas(fontFilePath), fontScale(fontSize / (float)GlyphAtlas::SDF_SIZE),
+		retainedVBOCapacity(0), holes(0), dirtyBegin(0), dirtyEnd(0),
+		maxWidth(0), maxHeight(0), minWidth(std::numeric_limits<float>::max()), minHeight(std::numeric_limits<float>::max())
 	{
 		addVertexShader("shaders/textVertex.vs");
 		addFragmentShader("shaders/textFragment.fs");
 		compileShader();
+		projection = glm::ortho(0.0f, windowWidth, 0.0f, windowHeight);
+
+		glGenVertexArrays(1, &VAO);
+		createVertexArray(retainedVAO, retainedVBO);
+	}
 
+	Text::~Text()
+	{
+		GLState::deleteVertexArrays(1, &VAO);
+		GLState::deleteBuffers(1, &retainedVBO);
+		GLState::deleteVertexArrays(1, &retainedVAO);
+	}
+
+	void Text::linked()
+	{
 		bind();
-		mat4 projection = glm::ortho(0.0f, windowWidth, 0.0f, windowHeight);
 		setUniformMat4("projection", projection);
 		unbind();
+	}
+
+	void Text::createVertexArray(unsigned int& vertexArray, unsigned int& buffer)
+	{
+		glGenVertexArrays(1, &vertexArray);
+		glGenBuffers(1, &buffer);
+		setVertexFormat(vertexArray, buffer);
+	}
+
+	void Text::setVertexFormat(unsigned int vertexArray, unsigned int buffer)
+	{
+		GLState::bindVertexArray(vertexArray);
+		GLState::bindBuffer(GL_ARRAY_BUFFER, buffer);
+		glEnableVertexAttribArray(0);
+		glVertexAttribPointer(0, 4, GL_FLOAT, GL_FALSE, sizeof(GlyphVertex), 0);
+		glEnableVertexAttribArray(1);
+		glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, sizeof(GlyphVertex), (GLvoid*)offsetof(GlyphVertex, color));
+		GLState::bindBuffer(GL_ARRAY_BUFFER, 0);
+		GLState::bindVertexArray(0);
+	}
 
-		glEnable(GL_BLEND);
-		glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+	void Text::layout(const string& text, GLfloat x, GLfloat y, GLfloat scale, const vec3& color, vector<GlyphVertex>& vertices)
+	{
+		scale *= fontScale;
+		for (unsigned int i = 0; i < text.size(); )
+		{
+			const Glyph& glyph = atlas.getGlyph(decodeUTF8(text, i));
 
-		FT_Library ft;
-		if (FT_Init_FreeType(&ft))
-			std::cout << "ERROR::FREETYPE: Could not init FreeType Library" << std::endl;
+			GLfloat xpos = x + glyph.offset.x * scale;
+			GLfloat ypos = y - (glyph.size.y - glyph.offset.y) * scale;
 
-		FT_Face face;
-		if (FT_New_Face(ft, fontFilePath, 0, &face))
-			std::cout << "ERROR::FREETYPE: Failed to load font" << std::endl;
+			GLfloat w = glyph.size.x * scale;
+			GLfloat h = glyph.size.y * scale;
 
-		FT_Set_Pixel_Sizes(face, 0, fontSize);
+			if (w > maxWidth) maxWidth = w;
+			if (h > maxHeight) maxHeight = h;
 
-		glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+			if (w < minWidth) minWidth = w;
+			if (h < minHeight) minHeight = h;
 
-		for (GLubyte c = 0; c < 128; c++)
-		{
-			if (FT_Load_Char(face, c, FT_LOAD_RENDER))
+			x += glyph.advance * scale;
+			if (w == 0 || h == 0)
 			{
-				std::cout << "ERROR::FREETYTPE: Failed to load Glyph" << std::endl;
 				continue;
 			}
-			GLuint texture;
-			glGenTextures(1, &texture);
-			glBindTexture(GL_TEXTURE_2D, texture);
-			glTexImage2D( GL_TEXTURE_2D, 0, GL_RED, face->glyph->bitmap.width, face->glyph->bitmap.rows, 0, GL_RED, GL_UNSIGNED_BYTE, face->glyph->bitmap.buffer);
-
-			glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_BORDER);
-			glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_BORDER);
-			glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-			glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-			
-			Character character = {
-				texture,
-				glm::ivec2(face->glyph->bitmap.width, face->glyph->bitmap.rows),
-				glm::ivec2(face->glyph->bitmap_left, face->glyph->bitmap_top),
-				face->glyph->advance.x
-			};
-			Characters.insert(std::pair<GLchar, Character>(c, character));
-		}
-		glBindTexture(GL_TEXTURE_2D, 0);
-		
-		FT_Done_Face(face);
-		FT_Done_FreeType(ft);
 
-		glGenVertexArrays(1, &VAO);
-		glGenBuffers(1, &VBO);
+			const vec4& uv = glyph.uvRect;
+			GlyphVertex quad[6] = {
+				{ vec2(xpos,     ypos + h), vec2(uv.x, uv.y), color },
+				{ vec2(xpos,     ypos),     vec2(uv.x, uv.w), color },
+				{ vec2(xpos + w, ypos),     vec2(uv.z, uv.w), color },
 
-		glBindVertexArray(VAO);
-		glBindBuffer(GL_ARRAY_BUFFER, VBO);
-		glBufferData(GL_ARRAY_BUFFER, sizeof(GLfloat) * 6 * 4, NULL, GL_DYNAMIC_DRAW);
-		glEnableVertexAttribArray(0);
-		glVertexAttribPointer(0, 4, GL_FLOAT, GL_FALSE, 4 * sizeof(GLfloat), 0);
-		glBindBuffer(GL_ARRAY_BUFFER, 0);
-		glBindVertexArray(0);
+				{ vec2(xpos,     ypos + h), vec2(uv.x, uv.y), color },
+				{ vec2(xpos + w, ypos),     vec2(uv.z, uv.w), color },
+				{ vec2(xpos + w, ypos + h), vec2(uv.z, uv.y), color }
+			};
+			vertices.insert(vertices.end(), quad, quad + 6);
+		}
 	}
 
-	Text::~Text()
+	void Text::draw(const string& text, GLfloat x, GLfloat y, GLfloat scale, const vec3& color)
 	{
-		for (const auto& letter : Characters)
-			glDeleteTextures(1, &letter.second.TextureID);
-		glDeleteBuffers(1, &VBO);
-		glDeleteVertexArrays(1, &VAO);
-
+		layout(text, x, y, scale, color, queued);
 	}
 
-	void Text::draw(const string& text, GLfloat x, GLfloat y, GLfloat scale, const vec3& color)
+	void Text::flush()
 	{
+		if (retained.empty() && queued.empty())
+		{
+			return;
+		}
+
 		bind();
+		GLState::enable(GL_BLEND);
+		GLState::blendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+		GLState::bindTexture(0, GL_TEXTURE_2D, atlas.getTexture());
+
+		if (!retained.empty())
+		{
+			GLState::bindBuffer(GL_ARRAY_BUFFER, retainedVBO);
+			if ((GLsizeiptr)retained.size() > retainedVBOCapacity)
+			{
+				retainedVBOCapacity = retained.size() * 2;
+				glBufferData(GL_ARRAY_BUFFER, retainedVBOCapacity * sizeof(GlyphVertex), NULL, GL_DYNAMIC_DRAW);
+				dirtyBegin = 0;
+				dirtyEnd = retained.size();
+			}
+			//only what changed since the last flush, usually nothing
+			dirtyEnd = glm::min(dirtyEnd, (GLint)retained.size());
+			if (dirtyEnd > dirtyBegin)
+			{
+				glBufferSubData(GL_ARRAY_BUFFER, dirtyBegin * sizeof(GlyphVertex), (dirtyEnd - dirtyBegin) * sizeof(GlyphVertex), &retained[dirtyBegin]);
+			}
+			dirtyBegin = dirtyEnd = 0;
 
-		setUniform3f("textColor", color);
-		glActiveTexture(GL_TEXTURE0);
-		glBindVertexArray(VAO);
+			GLState::bindVertexArray(retainedVAO);
+			glDrawArrays(GL_TRIANGLES, 0, retained.size());
+		}
 
-		string::const_iterator c;
-		for (c = text.begin(); c != text.end(); c++)
+		if (!queued.empty())
 		{
-			Character ch = Characters.at(*c);
+			stream.beginFrame();
+			GLintptr offset;
+			//vertex aligned so the offset is a first vertex for glDrawArrays
+			void* destination = stream.allocate(queued.size() * sizeof(GlyphVertex), sizeof(GlyphVertex), offset);
+			memcpy(destination, &queued[0], queued.size() * sizeof(GlyphVertex));
+			stream.flush();
+			if (stream.getBuffer() != streamedBuffer)
+			{
+				streamedBuffer = stream.getBuffer();
+				setVertexFormat(VAO, streamedBuffer);
+			}
 
-			GLfloat xpos = x + ch.Bearing.x * scale;
-			GLfloat ypos = y - (ch.Size.y - ch.Bearing.y) * scale;
+			GLState::bindVertexArray(VAO);
+			glDrawArrays(GL_TRIANGLES, offset / sizeof(GlyphVertex), queued.size());
+			stream.endFrame();
+			queued.clear();
+		}
+	}
 
-			GLfloat w = ch.Size.x * scale;
-			GLfloat h = ch.Size.y * scale;
+	unsigned int Text::retain(const string& text, GLfloat x, GLfloat y, GLfloat scale, const vec3& color)
+	{
+		unsigned int id;
+		if (!freeRegions.empty())
+		{
+			id = freeRegions.back();
+			freeRegions.pop_back();
+		}
+		else
+		{
+			id = regions.size();
+			regions.push_back(Region());
+		}
 
-			if (w > maxWidth) maxWidth = w;
-			if (h > maxHeight) maxHeight = h;
+		scratch.clear();
+		layout(text, x, y, scale, color, scratch);
 
-			if (w < minWidth) minWidth = w;
-			if (h < minHeight) minHeight = h;
+		//a quarter to spare so counters and the like can grow in place
+		Region& region = regions[id];
+		GLsizei glyphs = scratch.size() / VERTICES_PER_GLYPH;
+		region.first = retained.size();
+		region.count = scratch.size();
+		region.capacity = (glyphs + glyphs / 4 + 1) * VERTICES_PER_GLYPH;
+		retained.insert(retained.end(), scratch.begin(), scratch.end());
+		retained.resize(region.first + region.capacity, GlyphVertex());
+		markDirty(region.first, region.capacity);
+		return id;
+	}
 
-			GLfloat vertices[6][4] = {
-				{ xpos,     ypos + h,   0.0, 0.0 },
-				{ xpos,     ypos,       0.0, 1.0 },
-				{ xpos + w, ypos,       1.0, 1.0 },
+	void Text::update(unsigned int id, const string& text, GLfloat x, GLfloat y, GLfloat scale, const vec3& color)
+	{
+		Region& region = regions[id];
+		scratch.clear();
+		layout(text, x, y, scale, color, scratch);
+		if ((GLsizei)scratch.size() > region.capacity)
+		{
+			//outgrown, moves to the end and leaves a hole
+			release(id);
+			retain(text, x, y, scale, color);
+			return;
+		}
 
-				{ xpos,     ypos + h,   0.0, 0.0 },
-				{ xpos + w, ypos,       1.0, 1.0 },
-				{ xpos + w, ypos + h,   1.0, 0.0 }
-			};
-			
-			glBindTexture(GL_TEXTURE_2D, ch.TextureID);
+		std::copy(scratch.begin(), scratch.end(), retained.begin() + region.first);
+		if (region.count > (GLsizei)scratch.size())
+		{
+			clearRange(region.first + scratch.size(), region.count - scratch.size());
+		}
+		markDirty(region.first, glm::max(region.count, (GLsizei)scratch.size()));
+		region.count = scratch.size();
+	}
 
-			glBindBuffer(GL_ARRAY_BUFFER, VBO);
-			glBufferSubData(GL_ARRAY_BUFFER, 0, sizeof(vertices), vertices);
+	void Text::release(unsigned int id)
+	{
+		Region& region = regions[id];
+		clearRange(region.first, region.count);
+		markDirty(region.first, region.count);
+		holes += region.capacity;
+		region.count = region.capacity = 0;
+		freeRegions.push_back(id);
 
-			glBindBuffer(GL_ARRAY_BUFFER, 0);
-			
-			glDrawArrays(GL_TRIANGLES, 0, 6);
-			x += (ch.Advance >> 6) * scale; 
+		if (holes * 2 > (GLsizei)retained.size())
+		{
+			compact();
 		}
-		glBindVertexArray(0);
-		glBindTexture(GL_TEXTURE_2D, 0);
+	}
 
-		unbind();
+	void Text::clearRange(GLint first, GLsizei count)
+	{
+		//all zero makes degenerate triangles, cheaper to draw over than to split the draw
+		std::fill(retained.begin() + first, retained.begin() + first + count, GlyphVertex());
+	}
+
+	void Text::markDirty(GLint first, GLsizei count)
+	{
+		if (count == 0)
+		{
+			return;
+		}
+		if (dirtyEnd == dirtyBegin)
+		{
+			dirtyBegin = first;
+			dirtyEnd = first + count;
+			return;
+		}
+		dirtyBegin = glm::min(dirtyBegin, first);
+		dirtyEnd = glm::max(dirtyEnd, first + count);
+	}
+
+	void Text::compact()
+	{
+		vector<GlyphVertex> compacted;
+		for (unsigned int i = 0; i < regions.size(); i++)
+		{
+			Region& region = regions[i];
+			if (region.capacity == 0)
+			{
+				continue;
+			}
+			GLint first = compacted.size();
+			compacted.insert(compacted.end(), retained.begin() + region.first, retained.begin() + region.first + region.capacity);
+			region.first = first;
+		}
+		retained.swap(compacted);
+		holes = 0;
+		dirtyBegin = 0;
+		dirtyEnd = retained.size();
 	}
 
 	IText* textRenderFactory(float windowWidth, float windowHeight, const char* fontFilePath, unsigned int fontSize)
@@ -3,26 +3,59 @@
 
 #include "IText.h"
 #include "Shader.h"
+#include "GlyphAtlas.h"
+#include "StreamBuffer.h"
 #include <glm\glm.hpp>
-#include <ft2build.h>
-#include <freetype\freetype.h>
 
 
 namespace ginkgo {
 
-	struct Character {
-		GLuint TextureID;   // ID handle of the glyph texture
-		glm::ivec2 Size;    // Size of glyph
-		glm::ivec2 Bearing;  // Offset from baseline to left/top of glyph
-		GLuint Advance;    // Horizontal offset to advance to next glyph
+	//dependant on textVertex.vs
+	struct GlyphVertex
+	{
+		vec2 position;
+		vec2 uv;
+		vec3 color;
 	};
 
 	class Text : public Shader, public IText
 	{
 	private:
+		//a retained label's vertices, slack past count is kept degenerate
+		struct Region
+		{
+			GLint first;
+			GLsizei count;
+			GLsizei capacity;
+		};
+
+		//queued labels are streamed, VAO points at whichever buffer the stream last handed out
 		unsigned int VAO;
-		unsigned int VBO;
-		map<GLchar, Character> Characters;
+		StreamBuffer stream;
+		unsigned int streamedBuffer;
+		GlyphAtlas atlas;
+		float fontScale; //font size over the atlas' em size
+		vector<GlyphVertex> queued; //every label drawn since the last flush
+		vector<GlyphVertex> scratch;
+
+		//retained labels, mirrored in retainedVBO and drawn whole every flush
+		unsigned int retainedVAO;
+		unsigned int retainedVBO;
+		GLsizeiptr retainedVBOCapacity; //vertices
+		vector<GlyphVertex> retained;
+		vector<Region> regions;
+		vector<unsigned int> freeRegions;
+		GLsizei holes; //released or outgrown vertices, compacted away once they are half the buffer
+		GLint dirtyBegin;
+		GLint dirtyEnd;
+
+		void createVertexArray(unsigned int& vertexArray, unsigned int& buffer);
+		void setVertexFormat(unsigned int vertexArray, unsigned int buffer);
+		void clearRange(GLint first, GLsizei count);
+		void markDirty(GLint first, GLsizei count);
+		void compact();
+		void linked() override;
+		mat4 projection; //window sized, set on the program once it links
 		float maxWidth;
 		float maxHeight;
 		float minWidth;
@@ -31,7 +64,15 @@ namespace ginkgo {
 		Text(float windowWidth, float windowHeight, const char* fontFilePath, unsigned int fontSize);
 		~Text();
 
+		//two triangles per visible glyph, text is UTF-8
+		void layout(const string& text, GLfloat x, GLfloat y, GLfloat scale, const vec3& color, vector<GlyphVertex>& vertices);
+
 		void draw(const string& text, GLfloat x, GLfloat y, GLfloat scale, const vec3& color) override;
+		void flush() override;
+
+		unsigned int retain(const string& text, GLfloat x, GLfloat y, GLfloat scale, const vec3& color) override;
+		void update(unsigned int region, const string& text, GLfloat x, GLfloat y, GLfloat scale, const vec3& color) override;
+		void release(unsigned int region) override;
 
 		float getMaxCharWidth() const override { return maxWidth; }
 		float getMaxCharHeight() const override { return maxHeight; }
@@ -1,25 +1,52 @@
 #pragma once
 
 #include "RenderResource.h"
+#include "GLState.h"
 #include <glm/glm.hpp>
 #include <GL/glew.h>
 #include <FreeImage/FreeImage.h>
+#include <memory>
 
 namespace ginkgo {
 
+	//a GL_TEXTURE_2D_ARRAY, shared by every texture packed into it and deleted with the last of them
+	struct TextureStorage
+	{
+		GLuint tid;
+
+		TextureStorage()
+		{
+			glGenTextures(1, &tid);
+		}
+
+		~TextureStorage()
+		{
+			GLState::deleteTextures(1, &tid);
+		}
+	};
+
 	struct Texture
 	{
 	public:
 		string filepath;
-		GLuint tid;
+		std::shared_ptr<TextureStorage> storage;
+		GLuint tid; //storage->tid, always bound as GL_TEXTURE_2D_ARRAY
 		GLsizei width;
 		GLsizei height;
+		//where the image sits inside tid, picked up by materials using it
+		GLint layer;
+		vec4 uvRect; //offset xy, scale zw
 		static string whitepixelfilepath;
 	public:
-		~Texture()
-		{
-			glDeleteTextures(1, &tid);
-		}
+		//a texture with an array of its own
+		Texture()
+			: Texture(std::make_shared<TextureStorage>(), 0, vec4(0.0f, 0.0f, 1.0f, 1.0f))
+		{ }
+
+		//an image packed into a shared array or atlas
+		Texture(const std::shared_ptr<TextureStorage>& storage, GLint layer, const vec4& uvRect)
+			: storage(storage), tid(storage->tid), width(0), height(0), layer(layer), uvRect(uvRect)
+		{ }
 	};
 }
 
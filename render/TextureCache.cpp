@@ -0,0 +1,427 @@
+#include <fstream>
+#include <cstring>
+#include <cstddef>
+#include <climits>
+#include <utility>
+#include <atomic>
+#include <iostream>
+
+#include "TextureCache.h"
+#include "MappedFile.h"
+#include "GLState.h"
+
+namespace ginkgo {
+
+	namespace
+	{
+		const unsigned char KTX_IDENTIFIER[12] = { 0xAB, 0x4B, 0x54, 0x58, 0x20, 0x31, 0x31, 0xBB, 0x0D, 0x0A, 0x1A, 0x0A };
+		const uint32_t KTX_ENDIANNESS = 0x04030201;
+		const char SOURCE_KEY[] = "ginkgo.source"; //value: uint64 timestamp, uint64 hash
+		const GLsizei BC1_BLOCK_SIZE = 8; //bytes per 4x4 texels
+
+		struct KTXHeader
+		{
+			unsigned char identifier[12];
+			uint32_t endianness;
+			uint32_t glType;
+			uint32_t glTypeSize;
+			uint32_t glFormat;
+			uint32_t glInternalFormat;
+			uint32_t glBaseInternalFormat;
+			uint32_t pixelWidth;
+			uint32_t pixelHeight;
+			uint32_t pixelDepth;
+			uint32_t numberOfArrayElements;
+			uint32_t numberOfFaces;
+			uint32_t numberOfMipmapLevels;
+			uint32_t bytesOfKeyValueData;
+		};
+
+		//byte exact so the value directly follows the key, as the format wants
+#pragma pack(push, 1)
+		struct SourceKeyValue
+		{
+			uint32_t keyAndValueByteSize;
+			char key[sizeof(SOURCE_KEY)];
+			uint64_t timestamp;
+			uint64_t hash;
+			char padding[2]; //to 4 bytes
+		};
+#pragma pack(pop)
+		static_assert(sizeof(SourceKeyValue) % 4 == 0, "KTX key/value data must be 4 byte aligned");
+
+		//KTX pads key/value pairs and images to 4 bytes
+		uint32_t pad4(uint32_t size)
+		{
+			return (size + 3) & ~3u;
+		}
+
+		//saves come from the loader threads too, and a read-only install would fail every one of them
+		std::atomic<bool> reportedSaveFailure(false);
+
+		bool saveFailed(const string& cachePath)
+		{
+			if (!reportedSaveFailure.exchange(true))
+			{
+				std::cout << "Failed to write texture cache " << cachePath << ", textures are cooked again on every load!" << std::endl;
+			}
+			return false;
+		}
+
+		//the source was touched but hashes the same, stamp the entry so later loads skip the hash
+		//only once the mapping is closed, windows refuses writes to a mapped file
+		void refreshTimestamp(const string& cachePath, uint64_t timestamp)
+		{
+			std::fstream file(cachePath, std::ios::in | std::ios::out | std::ios::binary);
+			file.seekp(sizeof(KTXHeader) + offsetof(SourceKeyValue, timestamp));
+			file.write((const char*)&timestamp, sizeof(timestamp));
+			if (!file)
+			{
+				saveFailed(cachePath);
+			}
+		}
+
+		uint16_t to565(int r, int g, int b)
+		{
+			return (uint16_t)(((r >> 3) << 11) | ((g >> 2) << 5) | (b >> 3));
+		}
+
+		void from565(uint16_t c, int rgb[3])
+		{
+			rgb[0] = ((c >> 11) & 31) * 255 / 31;
+			rgb[1] = ((c >> 5) & 63) * 255 / 63;
+			rgb[2] = (c & 31) * 255 / 31;
+		}
+	}
+
+	bool TextureCache::isSupported()
+	{
+		return GLEW_EXT_texture_compression_s3tc != 0;
+	}
+
+	string TextureCache::getCachePath(const string& sourcePath)
+	{
+		return sourcePath + ".ktx";
+	}
+
+	//2x2 box filter, the last row/column is repeated on odd sizes
+	void TextureCache::buildMip(const vector<unsigned char>& source, GLsizei width, GLsizei height, vector<unsigned char>& destination)
+	{
+		GLsizei mipWidth = glm::max(1, width / 2);
+		GLsizei mipHeight = glm::max(1, height / 2);
+		destination.resize(mipWidth * mipHeight * 3);
+
+		for (GLsizei y = 0; y < mipHeight; y++)
+		{
+			GLsizei y0 = glm::min(y * 2, height - 1);
+			GLsizei y1 = glm::min(y * 2 + 1, height - 1);
+			for (GLsizei x = 0; x < mipWidth; x++)
+			{
+				GLsizei x0 = glm::min(x * 2, width - 1);
+				GLsizei x1 = glm::min(x * 2 + 1, width - 1);
+				for (int c = 0; c < 3; c++)
+				{
+					int sum = source[(y0 * width + x0) * 3 + c] + source[(y0 * width + x1) * 3 + c] +
+						source[(y1 * width + x0) * 3 + c] + source[(y1 * width + x1) * 3 + c];
+					destination[(y * mipWidth + x) * 3 + c] = (unsigned char)((sum + 2) / 4);
+				}
+			}
+		}
+	}
+
+	//range fit: endpoints from the inset bounding box of the block, each texel takes the nearest of the four palette colors
+	void TextureCache::compressBC1(const unsigned char* pixels, GLsizei width, GLsizei height, vector<unsigned char>& blocks)
+	{
+		GLsizei blocksWide = (width + 3) / 4;
+		GLsizei blocksHigh = (height + 3) / 4;
+		blocks.resize(blocksWide * blocksHigh * BC1_BLOCK_SIZE);
+
+		for (GLsizei by = 0; by < blocksHigh; by++)
+		{
+			for (GLsizei bx = 0; bx < blocksWide; bx++)
+			{
+				//RGB, edge blocks repeat the last row/column
+				int texels[16][3];
+				int lo[3] = { 255, 255, 255 };
+				int hi[3] = { 0, 0, 0 };
+				for (int t = 0; t < 16; t++)
+				{
+					GLsizei x = glm::min(bx * 4 + (t & 3), width - 1);
+					GLsizei y = glm::min(by * 4 + (t >> 2), height - 1);
+					const unsigned char* p = pixels + (y * width + x) * 3;
+					texels[t][0] = p[2];
+					texels[t][1] = p[1];
+					texels[t][2] = p[0];
+					for (int c = 0; c < 3; c++)
+					{
+						lo[c] = glm::min(lo[c], texels[t][c]);
+						hi[c] = glm::max(hi[c], texels[t][c]);
+					}
+				}
+				for (int c = 0; c < 3; c++)
+				{
+					int inset = (hi[c] - lo[c]) / 16;
+					lo[c] += inset;
+					hi[c] -= inset;
+				}
+
+				uint16_t color0 = to565(hi[0], hi[1], hi[2]);
+				uint16_t color1 = to565(lo[0], lo[1], lo[2]);
+				if (color0 < color1)
+				{
+					std::swap(color0, color1);
+				}
+
+				uint32_t indices = 0;
+				if (color0 != color1)
+				{
+					//four color mode, only used when color0 > color1
+					int palette[4][3];
+					from565(color0, palette[0]);
+					from565(color1, palette[1]);
+					for (int c = 0; c < 3; c++)
+					{
+						palette[2][c] = (2 * palette[0][c] + palette[1][c]) / 3;
+						palette[3][c] = (palette[0][c] + 2 * palette[1][c]) / 3;
+					}
+
+					for (int t = 0; t < 16; t++)
+					{
+						int best = 0;
+						int bestDistance = INT_MAX;
+						for (int i = 0; i < 4; i++)
+						{
+							int dr = texels[t][0] - palette[i][0];
+							int dg = texels[t][1] - palette[i][1];
+							int db = texels[t][2] - palette[i][2];
+							int distance = dr * dr + dg * dg + db * db;
+							if (distance < bestDistance)
+							{
+								bestDistance = distance;
+								best = i;
+							}
+						}
+						indices |= (uint32_t)best << (t * 2);
+					}
+				}
+
+				unsigned char* block = &blocks[(by * blocksWide + bx) * BC1_BLOCK_SIZE];
+				memcpy(block, &color0, 2);
+				memcpy(block + 2, &color1, 2);
+				memcpy(block + 4, &indices, 4);
+			}
+		}
+	}
+
+	CookedTexture TextureCache::cook(const unsigned char* pixels, GLsizei width, GLsizei height)
+	{
+		CookedTexture cooked;
+		cooked.internalFormat = GL_COMPRESSED_RGB_S3TC_DXT1_EXT;
+
+		vector<unsigned char> level(pixels, pixels + width * height * 3);
+		vector<unsigned char> next;
+		while (true)
+		{
+			cooked.levels.emplace_back();
+			CookedTexture::Level& out = cooked.levels.back();
+			out.width = width;
+			out.height = height;
+			compressBC1(&level[0], width, height, out.data);
+
+			if (width == 1 && height == 1)
+			{
+				break;
+			}
+			buildMip(level, width, height, next);
+			level.swap(next);
+			width = glm::max(1, width / 2);
+			height = glm::max(1, height / 2);
+		}
+		return cooked;
+	}
+
+	bool TextureCache::read(const string& cachePath, const string& sourcePath, CookedTexture& cooked)
+	{
+		uint64_t timestamp;
+		bool touched;
+		{
+			MappedFile cache(cachePath);
+			if (cache.getSize() < sizeof(KTXHeader) + sizeof(SourceKeyValue))
+			{
+				return false;
+			}
+
+			const KTXHeader& header = *(const KTXHeader*)cache.getData();
+			if (memcmp(header.identifier, KTX_IDENTIFIER, sizeof(KTX_IDENTIFIER)) != 0 || header.endianness != KTX_ENDIANNESS ||
+				header.glInternalFormat != GL_COMPRESSED_RGB_S3TC_DXT1_EXT || header.numberOfFaces != 1 || header.numberOfMipmapLevels == 0 ||
+				header.bytesOfKeyValueData != sizeof(SourceKeyValue))
+			{
+				return false;
+			}
+
+			//a touched but unchanged source (checkout, copy) still matches on the hash
+			const SourceKeyValue& source = *(const SourceKeyValue*)(cache.getData() + sizeof(KTXHeader));
+			uint64_t hash;
+			if (strcmp(source.key, SOURCE_KEY) != 0 || !MappedFile::getTimestamp(sourcePath, timestamp))
+			{
+				return false;
+			}
+			if (timestamp != source.timestamp && (!MappedFile::hashFile(sourcePath, hash) || hash != source.hash))
+			{
+				return false;
+			}
+
+			cooked.internalFormat = header.glInternalFormat;
+			cooked.levels.resize(header.numberOfMipmapLevels);
+			uint64_t offset = sizeof(KTXHeader) + header.bytesOfKeyValueData;
+			GLsizei width = header.pixelWidth;
+			GLsizei height = header.pixelHeight;
+			for (uint32_t i = 0; i < header.numberOfMipmapLevels; i++)
+			{
+				if (offset + sizeof(uint32_t) > cache.getSize())
+				{
+					return false;
+				}
+				uint32_t imageSize = *(const uint32_t*)(cache.getData() + offset);
+				offset += sizeof(uint32_t);
+				if (offset + imageSize > cache.getSize())
+				{
+					return false;
+				}
+
+				CookedTexture::Level& level = cooked.levels[i];
+				level.width = width;
+				level.height = height;
+				level.data.assign(cache.getData() + offset, cache.getData() + offset + imageSize);
+				offset += pad4(imageSize);
+				width = glm::max(1, width / 2);
+				height = glm::max(1, height / 2);
+			}
+			touched = timestamp != source.timestamp;
+		}
+		if (touched)
+		{
+			refreshTimestamp(cachePath, timestamp);
+		}
+		return true;
+	}
+
+	bool TextureCache::save(const string& cachePath, const string& sourcePath, const CookedTexture& cooked)
+	{
+		if (cooked.levels.empty())
+		{
+			return false;
+		}
+
+		SourceKeyValue source = {};
+		source.keyAndValueByteSize = sizeof(SOURCE_KEY) + 2 * sizeof(uint64_t);
+		memcpy(source.key, SOURCE_KEY, sizeof(SOURCE_KEY));
+		if (!MappedFile::getTimestamp(sourcePath, source.timestamp) || !MappedFile::hashFile(sourcePath, source.hash))
+		{
+			return saveFailed(cachePath);
+		}
+
+		KTXHeader header = {};
+		memcpy(header.identifier, KTX_IDENTIFIER, sizeof(KTX_IDENTIFIER));
+		header.endianness = KTX_ENDIANNESS;
+		header.glTypeSize = 1; //compressed: glType and glFormat stay 0
+		header.glInternalFormat = cooked.internalFormat;
+		header.glBaseInternalFormat = GL_RGB;
+		header.pixelWidth = cooked.levels[0].width;
+		header.pixelHeight = cooked.levels[0].height;
+		header.numberOfFaces = 1;
+		header.numberOfMipmapLevels = cooked.levels.size();
+		header.bytesOfKeyValueData = sizeof(SourceKeyValue);
+
+		std::ofstream out(cachePath, std::ios::binary | std::ios::trunc);
+		out.write((const char*)&header, sizeof(header));
+		out.write((const char*)&source, sizeof(source));
+		for (unsigned int i = 0; i < cooked.levels.size(); i++)
+		{
+			static const char padding[3] = {};
+			uint32_t imageSize = cooked.levels[i].data.size();
+			out.write((const char*)&imageSize, sizeof(imageSize));
+			out.write((const char*)&cooked.levels[i].data[0], imageSize);
+			out.write(padding, pad4(imageSize) - imageSize);
+		}
+		return out.good() || saveFailed(cachePath);
+	}
+
+	GLsizei TextureCache::getLevelSize(GLsizei width, GLsizei height)
+	{
+		return ((width + 3) / 4) * ((height + 3) / 4) * BC1_BLOCK_SIZE;
+	}
+
+	void TextureCache::allocate(GLuint tid, GLenum internalFormat, GLsizei width, GLsizei height, GLsizei levels, GLsizei layers, bool pixelate)
+	{
+		GLState::bindTexture(GL_TEXTURE_2D_ARRAY, tid);
+		for (GLsizei i = 0; i < levels; i++)
+		{
+			glCompressedTexImage3D(GL_TEXTURE_2D_ARRAY, i, internalFormat, width, height, layers, 0, getLevelSize(width, height) * layers, NULL);
+			width = glm::max(1, width / 2);
+			height = glm::max(1, height / 2);
+		}
+		glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_BASE_LEVEL, 0);
+		glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAX_LEVEL, levels - 1);
+		glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MIN_FILTER, (pixelate) ? GL_NEAREST_MIPMAP_NEAREST : GL_LINEAR_MIPMAP_LINEAR);
+		glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAG_FILTER, (pixelate) ? GL_NEAREST : GL_LINEAR);
+	}
+
+	void TextureCache::upload(const CookedTexture& cooked, GLuint tid, bool pixelate, GLuint unpackBuffer)
+	{
+		const CookedTexture::Level& base = cooked.levels[0];
+		allocate(tid, cooked.internalFormat, base.width, base.height, cooked.levels.size(), 1, pixelate);
+		uploadLayer(cooked, 0, unpackBuffer);
+		GLState::bindTexture(GL_TEXTURE_2D_ARRAY, 0);
+	}
+
+	void TextureCache::uploadLayer(const CookedTexture& cooked, GLint layer, GLuint unpackBuffer)
+	{
+		vector<const GLvoid*> sources(cooked.levels.size());
+		unsigned char* mapped = nullptr;
+		if (unpackBuffer != 0)
+		{
+			GLsizeiptr total = 0;
+			for (unsigned int i = 0; i < cooked.levels.size(); i++)
+			{
+				total += cooked.levels[i].data.size();
+			}
+			GLState::bindBuffer(GL_PIXEL_UNPACK_BUFFER, unpackBuffer);
+			//orphans the previous upload's storage instead of waiting on it
+			glBufferData(GL_PIXEL_UNPACK_BUFFER, total, NULL, GL_STREAM_DRAW);
+			mapped = (unsigned char*)glMapBufferRange(GL_PIXEL_UNPACK_BUFFER, 0, total, GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_BUFFER_BIT);
+			if (mapped == nullptr)
+			{
+				GLState::bindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+			}
+		}
+
+		GLintptr offset = 0;
+		for (unsigned int i = 0; i < cooked.levels.size(); i++)
+		{
+			const vector<unsigned char>& data = cooked.levels[i].data;
+			if (mapped != nullptr)
+			{
+				memcpy(mapped + offset, &data[0], data.size());
+				sources[i] = (const GLvoid*)offset;
+				offset += data.size();
+			}
+			else
+			{
+				sources[i] = &data[0];
+			}
+		}
+		if (mapped != nullptr)
+		{
+			glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER);
+		}
+
+		for (unsigned int i = 0; i < cooked.levels.size(); i++)
+		{
+			const CookedTexture::Level& level = cooked.levels[i];
+			glCompressedTexSubImage3D(GL_TEXTURE_2D_ARRAY, i, 0, 0, layer, level.width, level.height, 1, cooked.internalFormat, level.data.size(), sources[i]);
+		}
+		GLState::bindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+	}
+
+}
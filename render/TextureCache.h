@@ -0,0 +1,55 @@
+#pragma once
+
+#include "RenderResource.h"
+#include <GL/glew.h>
+#include <cstdint>
+
+namespace ginkgo {
+
+	//a full mip chain, compressed, ready for glCompressedTexImage2D
+	struct CookedTexture
+	{
+		struct Level
+		{
+			GLsizei width;
+			GLsizei height;
+			vector<unsigned char> data;
+		};
+
+		GLenum internalFormat;
+		vector<Level> levels;
+	};
+
+	//cooks 24 bit images into BC1 (DXT1) mip chains and keeps them next to the source as KTX 1.1 files
+	//the KTX key/value data carries the source's timestamp and hash so edits invalidate the cache
+	class TextureCache
+	{
+	public:
+		//false if the driver can't sample S3TC, callers then upload uncompressed and let GL build the mips
+		static bool isSupported();
+
+		static string getCachePath(const string& sourcePath);
+
+		//pixels are 24 bit BGR, bottom row first, as FileUtils::loadImage returns them
+		static CookedTexture cook(const unsigned char* pixels, GLsizei width, GLsizei height);
+
+		//no GL, safe on a worker thread
+		static bool read(const string& cachePath, const string& sourcePath, CookedTexture& cooked);
+		//false if there was nothing cooked or on io failure, the first io failure is logged
+		static bool save(const string& cachePath, const string& sourcePath, const CookedTexture& cooked);
+
+		//uploads every level into tid as a single layer array and sets up mipmapped filtering
+		//with an unpack buffer the data goes through it so the call doesn't wait on the copy
+		static void upload(const CookedTexture& cooked, GLuint tid, bool pixelate, GLuint unpackBuffer = 0);
+		//storage for layers images of the same size and level count, left bound as GL_TEXTURE_2D_ARRAY
+		static void allocate(GLuint tid, GLenum internalFormat, GLsizei width, GLsizei height, GLsizei levels, GLsizei layers, bool pixelate);
+		//into the bound array, cooked must match what it was allocated with
+		static void uploadLayer(const CookedTexture& cooked, GLint layer, GLuint unpackBuffer = 0);
+
+	private:
+		static GLsizei getLevelSize(GLsizei width, GLsizei height);
+		static void buildMip(const vector<unsigned char>& source, GLsizei width, GLsizei height, vector<unsigned char>& destination);
+		static void compressBC1(const unsigned char* pixels, GLsizei width, GLsizei height, vector<unsigned char>& blocks);
+	};
+
+}
@@ -0,0 +1,278 @@
+#include "TexturePacker.h"
+
+#include "Texture.h"
+#include "TextureCache.h"
+#include "FileUtils.h"
+#include "GLState.h"
+
+#include <algorithm>
+#include <cstring>
+#include <memory>
+#include <utility>
+
+namespace ginkgo {
+
+	namespace
+	{
+		const GLsizei ALL_LEVELS = 0;
+
+		struct Image
+		{
+			string path;
+			GLsizei width;
+			GLsizei height;
+			unsigned char* pixels; //24 bit BGR, nullptr while only the cooked version is loaded
+			CookedTexture cooked;
+		};
+
+		struct Placement
+		{
+			unsigned int image;
+			GLint page;
+			GLint x;
+			GLint y;
+		};
+
+		bool decode(Image& image)
+		{
+			if (image.pixels == nullptr)
+			{
+				image.pixels = FileUtils::loadImage(image.path.c_str(), &image.width, &image.height);
+			}
+			return image.pixels != nullptr;
+		}
+
+		//cooking and saving it if the cache didn't have it
+		void cook(Image& image)
+		{
+			if (!image.cooked.levels.empty())
+			{
+				return;
+			}
+			image.cooked = TextureCache::cook(image.pixels, image.width, image.height);
+			TextureCache::save(TextureCache::getCachePath(image.path), image.path, image.cooked);
+		}
+
+		//drivers without S3TC, GL builds the mips
+		void uploadUncompressed(GLuint tid, GLsizei width, GLsizei height, const vector<const unsigned char*>& layers, GLsizei levels, bool pixelate)
+		{
+			GLint alignment;
+			glGetIntegerv(GL_UNPACK_ALIGNMENT, &alignment);
+			glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+			GLState::bindTexture(GL_TEXTURE_2D_ARRAY, tid);
+			glTexImage3D(GL_TEXTURE_2D_ARRAY, 0, GL_RGB, width, height, layers.size(), 0, GL_BGR, GL_UNSIGNED_BYTE, NULL);
+			for (unsigned int i = 0; i < layers.size(); i++)
+			{
+				glTexSubImage3D(GL_TEXTURE_2D_ARRAY, 0, 0, 0, i, width, height, 1, GL_BGR, GL_UNSIGNED_BYTE, layers[i]);
+			}
+			if (levels != ALL_LEVELS)
+			{
+				glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAX_LEVEL, levels - 1);
+			}
+			glGenerateMipmap(GL_TEXTURE_2D_ARRAY);
+			glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MIN_FILTER, (pixelate) ? GL_NEAREST_MIPMAP_NEAREST : GL_LINEAR_MIPMAP_LINEAR);
+			glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAG_FILTER, (pixelate) ? GL_NEAREST : GL_LINEAR);
+			GLState::bindTexture(GL_TEXTURE_2D_ARRAY, 0);
+			glPixelStorei(GL_UNPACK_ALIGNMENT, alignment);
+		}
+
+		//images must all be the same size, one layer each in the order given
+		void packArray(vector<Image>& images, const vector<unsigned int>& group, bool pixelate, vector<Texture*>& textures)
+		{
+			const Image& first = images[group[0]];
+			std::shared_ptr<TextureStorage> storage = std::make_shared<TextureStorage>();
+			if (TextureCache::isSupported())
+			{
+				for (unsigned int i = 0; i < group.size(); i++)
+				{
+					cook(images[group[i]]);
+				}
+				TextureCache::allocate(storage->tid, first.cooked.internalFormat, first.width, first.height, first.cooked.levels.size(), group.size(), pixelate);
+				for (unsigned int i = 0; i < group.size(); i++)
+				{
+					TextureCache::uploadLayer(images[group[i]].cooked, i);
+				}
+				GLState::bindTexture(GL_TEXTURE_2D_ARRAY, 0);
+			}
+			else
+			{
+				vector<const unsigned char*> layers;
+				for (unsigned int i = 0; i < group.size(); i++)
+				{
+					layers.push_back(images[group[i]].pixels);
+				}
+				uploadUncompressed(storage->tid, first.width, first.height, layers, ALL_LEVELS, pixelate);
+			}
+
+			for (unsigned int i = 0; i < group.size(); i++)
+			{
+				Texture* t = new Texture(storage, i, vec4(0.0f, 0.0f, 1.0f, 1.0f));
+				t->filepath = images[group[i]].path;
+				t->width = first.width;
+				t->height = first.height;
+				textures[group[i]] = t;
+			}
+		}
+
+		void packAtlas(vector<Image>& images, vector<unsigned int> group, bool pixelate, vector<Texture*>& textures)
+		{
+			const GLsizei size = TexturePacker::ATLAS_SIZE;
+			const GLsizei padding = TexturePacker::ATLAS_PADDING;
+
+			//shelves, tallest images first so each shelf wastes little above the shorter ones
+			for (unsigned int i = 0; i < group.size(); i++)
+			{
+				decode(images[group[i]]);
+			}
+			std::sort(group.begin(), group.end(), [&images](unsigned int a, unsigned int b) { return images[a].height > images[b].height; });
+
+			vector<Placement> placements;
+			GLint page = 0, x = 0, y = 0, shelfHeight = 0;
+			for (unsigned int i = 0; i < group.size(); i++)
+			{
+				const Image& image = images[group[i]];
+				if (image.pixels == nullptr)
+				{
+					continue;
+				}
+				//rounded up to whole BC1 blocks so no block straddles two images
+				GLint w = (image.width + 2 * padding + 3) & ~3;
+				GLint h = (image.height + 2 * padding + 3) & ~3;
+				if (x + w > size)
+				{
+					x = 0;
+					y += shelfHeight;
+					shelfHeight = 0;
+				}
+				if (y + h > size)
+				{
+					page++;
+					x = y = shelfHeight = 0;
+				}
+				Placement placement = { group[i], page, x, y };
+				placements.push_back(placement);
+				x += w;
+				shelfHeight = glm::max(shelfHeight, h);
+			}
+			if (placements.empty())
+			{
+				return;
+			}
+
+			vector<vector<unsigned char>> pages(page + 1, vector<unsigned char>(size * size * 3, 0));
+			for (unsigned int i = 0; i < placements.size(); i++)
+			{
+				const Placement& placement = placements[i];
+				const Image& image = images[placement.image];
+				unsigned char* destination = &pages[placement.page][0];
+				for (GLint row = -padding; row < image.height + padding; row++)
+				{
+					GLint sourceRow = glm::clamp(row, 0, image.height - 1);
+					for (GLint column = -padding; column < image.width + padding; column++)
+					{
+						GLint sourceColumn = glm::clamp(column, 0, image.width - 1);
+						const unsigned char* texel = image.pixels + (sourceRow * image.width + sourceColumn) * 3;
+						memcpy(destination + ((placement.y + padding + row) * size + placement.x + padding + column) * 3, texel, 3);
+					}
+				}
+			}
+
+			//pages differ with every combination of images so they are cooked every load rather than cached
+			std::shared_ptr<TextureStorage> storage = std::make_shared<TextureStorage>();
+			if (TextureCache::isSupported())
+			{
+				vector<CookedTexture> cooked(pages.size());
+				for (unsigned int i = 0; i < pages.size(); i++)
+				{
+					cooked[i] = TextureCache::cook(&pages[i][0], size, size);
+					cooked[i].levels.resize(TexturePacker::ATLAS_LEVELS);
+				}
+				TextureCache::allocate(storage->tid, cooked[0].internalFormat, size, size, TexturePacker::ATLAS_LEVELS, pages.size(), pixelate);
+				for (unsigned int i = 0; i < pages.size(); i++)
+				{
+					TextureCache::uploadLayer(cooked[i], i);
+				}
+				GLState::bindTexture(GL_TEXTURE_2D_ARRAY, 0);
+			}
+			else
+			{
+				vector<const unsigned char*> layers;
+				for (unsigned int i = 0; i < pages.size(); i++)
+				{
+					layers.push_back(&pages[i][0]);
+				}
+				uploadUncompressed(storage->tid, size, size, layers, TexturePacker::ATLAS_LEVELS, pixelate);
+			}
+
+			for (unsigned int i = 0; i < placements.size(); i++)
+			{
+				const Placement& placement = placements[i];
+				const Image& image = images[placement.image];
+				vec4 uvRect((placement.x + padding) / (float)size, (placement.y + padding) / (float)size, image.width / (float)size, image.height / (float)size);
+				Texture* t = new Texture(storage, placement.page, uvRect);
+				t->filepath = image.path;
+				t->width = image.width;
+				t->height = image.height;
+				textures[placement.image] = t;
+			}
+		}
+	}
+
+	vector<Texture*> TexturePacker::pack(const vector<string>& paths, bool pixelate)
+	{
+		vector<Texture*> textures(paths.size(), nullptr);
+		vector<Image> images(paths.size());
+		map<std::pair<GLsizei, GLsizei>, vector<unsigned int>> sizes;
+		for (unsigned int i = 0; i < paths.size(); i++)
+		{
+			Image& image = images[i];
+			image.path = paths[i];
+			image.width = image.height = 0;
+			image.pixels = nullptr;
+			if (TextureCache::isSupported() && TextureCache::read(TextureCache::getCachePath(image.path), image.path, image.cooked))
+			{
+				image.width = image.cooked.levels[0].width;
+				image.height = image.cooked.levels[0].height;
+			}
+			else if (!decode(image))
+			{
+				//TODO: error handle (return static checkerboard texture source engine style)
+				continue;
+			}
+			sizes[std::make_pair(image.width, image.height)].push_back(i);
+		}
+
+		vector<unsigned int> atlased;
+		for (auto it = sizes.begin(); it != sizes.end(); ++it)
+		{
+			const vector<unsigned int>& group = it->second;
+			if (group.size() == 1 && glm::max(it->first.first, it->first.second) <= ATLAS_MAX_IMAGE)
+			{
+				atlased.push_back(group[0]);
+				continue;
+			}
+			packArray(images, group, pixelate, textures);
+		}
+		//an atlas page for a single image would only waste memory
+		if (atlased.size() == 1)
+		{
+			packArray(images, atlased, pixelate, textures);
+		}
+		else if (atlased.size() > 1)
+		{
+			packAtlas(images, atlased, pixelate, textures);
+		}
+
+		for (unsigned int i = 0; i < images.size(); i++)
+		{
+			delete[] images[i].pixels;
+		}
+		return textures;
+	}
+
+	Texture* TexturePacker::load(const string& path, bool pixelate)
+	{
+		return pack(vector<string>(1, path), pixelate)[0];
+	}
+
+}
@@ -0,0 +1,25 @@
+#pragma once
+
+#include "RenderResource.h"
+#include <GL/glew.h>
+
+namespace ginkgo {
+
+	struct Texture;
+
+	//loads images into GL_TEXTURE_2D_ARRAYs so materials using any of them can share one texture binding
+	//images of the same size become layers of one array, small ones are shelf packed into atlas pages which are layers of another
+	class TexturePacker
+	{
+	public:
+		static const GLsizei ATLAS_SIZE = 1024;
+		static const GLsizei ATLAS_MAX_IMAGE = 256; //anything larger keeps an array of its own
+		static const GLsizei ATLAS_PADDING = 4; //edge texels repeated around each image, also keeps images on BC1 block boundaries
+		static const GLsizei ATLAS_LEVELS = 3; //deeper mips would bleed across the padding
+
+		//in the order of paths, nullptr where the image failed to load
+		static vector<Texture*> pack(const vector<string>& paths, bool pixelate);
+		static Texture* load(const string& path, bool pixelate);
+	};
+
+}
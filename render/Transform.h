@@ -1,58 +1,56 @@
 #pragma once
 
 #include "ITransform.h"
+#include "TransformHierarchy.h"
 #include <glm/gtx/quaternion.hpp>
 
 namespace ginkgo {
 
+	//a handle to one node of the TransformHierarchy, which rebuilds the matrix
+	//keeps its own copy of translation, rotation and scale so the getters stay valid
 	class Transform : public ITransform
 	{
 	private:
-		mutable mat4 matrix;
+		unsigned int node;
 		vec3 dilation;
 		vec3 translation;
 		quat rot;
-		mat4 identity;
-		mutable bool matrixOOD;
+
+		Transform(const Transform&) = delete;
+		Transform& operator=(const Transform&) = delete;
 	public:
 		Transform()
 		{
+			node = TransformHierarchy::create();
 			rot = glm::angleAxis(0.f, vec3(0, 1, 0));
 			dilation = vec3(1, 1, 1);
 			translation = vec3();
-			matrixOOD = true;
-			getMatrix();
 		}
 
-		const mat4& getMatrix() const override 
-		{
-			if (matrixOOD)
-			{
-				matrixOOD = false;
-				matrix = translate(identity, translation) * rotate(identity, glm::angle(rot), glm::axis(rot)) * glm::scale(identity, dilation);
-			}
-			return matrix; 
-		}
+		~Transform() { TransformHierarchy::destroy(node); }
+
+		//valid for as long as this Transform
+		const mat4& getMatrix() const override { return TransformHierarchy::getWorld(node); }
 
-		void setMatrix(const mat4& matrix) override { this->matrix = matrix; }
+		void setMatrix(const mat4& matrix) override { TransformHierarchy::setLocal(node, matrix); }
 		
 		void scaleMatrix(const vec3& scale) override
 		{ 
 			dilation = scale;
-			matrixOOD = true;
+			TransformHierarchy::setScale(node, scale);
 		}
 
 		void translateMatrix(const vec3& translation) override
 		{ 
 			this->translation = translation;
-			matrixOOD = true;
+			TransformHierarchy::setTranslation(node, translation);
 		}
 
 		void rotateMatrix(quat const& rotation) override 
 		{
 			rot = rotation;
 			rot.z = -rot.z;
-			matrixOOD = true;
+			TransformHierarchy::setRotation(node, rot);
 		}
 
 		vec3 const& getScale() const override
@@ -69,6 +67,13 @@ namespace ginkgo {
 		{
 			return rot;
 		}
+
+		void setParent(ITransform* parent) override
+		{
+			TransformHierarchy::setParent(node, (parent != nullptr) ? (int)static_cast<Transform*>(parent)->node : TransformHierarchy::NO_PARENT);
+		}
+
+		unsigned int getVersion() const override { return TransformHierarchy::getVersion(node); }
 	};
 
 }
@@ -0,0 +1,418 @@
+#include <xmmintrin.h>
+#include <iostream>
+#include <memory>
+#include <thread>
+#include <algorithm>
+#include <cassert>
+
+#include "TransformHierarchy.h"
+
+namespace ginkgo {
+
+	namespace
+	{
+		enum NodeFlags
+		{
+			LOCAL_DIRTY = 1, //translation, rotation or scale changed
+			WORLD_DIRTY = 2, //local matrix changed
+			ALIVE = 4
+		};
+
+		//blocks of CHUNK_SIZE that never move once allocated, so references stay valid as nodes are added
+		template <typename T>
+		class ChunkedArray
+		{
+		private:
+			static const unsigned int CHUNK_SIZE = 256;
+			vector<std::unique_ptr<T[]>> chunks;
+			unsigned int count;
+		public:
+			ChunkedArray() : count(0) {}
+
+			T& operator[](unsigned int i) { return chunks[i / CHUNK_SIZE][i % CHUNK_SIZE]; }
+			const T& operator[](unsigned int i) const { return chunks[i / CHUNK_SIZE][i % CHUNK_SIZE]; }
+			unsigned int size() const { return count; }
+
+			void emplace_back(const T& value = T())
+			{
+				if (count % CHUNK_SIZE == 0)
+				{
+					chunks.emplace_back(new T[CHUNK_SIZE]);
+				}
+				(*this)[count++] = value;
+			}
+		};
+
+		struct Nodes
+		{
+			ChunkedArray<vec3> translations;
+			ChunkedArray<quat> rotations;
+			ChunkedArray<vec3> scales;
+			ChunkedArray<mat4> locals;
+			ChunkedArray<mat4> worlds;
+			ChunkedArray<int> parents;
+			ChunkedArray<vector<unsigned int>> children; //so destroy only visits its own
+			ChunkedArray<unsigned int> versions;
+			ChunkedArray<unsigned int> parentVersions; //the parent's version when the world matrix was built
+			ChunkedArray<unsigned char> flags;
+
+			vector<unsigned int> freeNodes;
+			vector<unsigned int> order; //live nodes, every parent before its children
+			bool orderDirty;
+
+			//update scratch
+			vector<unsigned int> localDirty;
+			unsigned int updated;
+
+			Nodes() : orderDirty(false), updated(0) {}
+		};
+
+		Nodes nodes;
+
+		//nothing is locked, one thread owns every node, the first to use them (the render thread, which also makes the renderables)
+		void checkThread()
+		{
+			static std::thread::id owner = std::this_thread::get_id();
+			assert(owner == std::this_thread::get_id() && "transforms may only be made, changed or read on the render thread");
+		}
+
+		void detach(unsigned int n)
+		{
+			int parent = nodes.parents[n];
+			if (parent != TransformHierarchy::NO_PARENT)
+			{
+				vector<unsigned int>& siblings = nodes.children[parent];
+				siblings.erase(std::find(siblings.begin(), siblings.end(), n));
+				nodes.parents[n] = TransformHierarchy::NO_PARENT;
+			}
+		}
+
+		//m = translate * rotate * scale, without the acos and sqrt of going through angle and axis
+		void buildLocal(unsigned int n)
+		{
+			const quat& q = nodes.rotations[n];
+			const vec3& s = nodes.scales[n];
+			const vec3& t = nodes.translations[n];
+			float k = 2.0f / (q.x * q.x + q.y * q.y + q.z * q.z + q.w * q.w);
+			float xx = q.x * q.x * k, yy = q.y * q.y * k, zz = q.z * q.z * k;
+			float xy = q.x * q.y * k, xz = q.x * q.z * k, yz = q.y * q.z * k;
+			float wx = q.w * q.x * k, wy = q.w * q.y * k, wz = q.w * q.z * k;
+
+			mat4& m = nodes.locals[n];
+			m[0] = vec4((1 - yy - zz) * s.x, (xy + wz) * s.x, (xz - wy) * s.x, 0);
+			m[1] = vec4((xy - wz) * s.y, (1 - xx - zz) * s.y, (yz + wx) * s.y, 0);
+			m[2] = vec4((xz + wy) * s.z, (yz - wx) * s.z, (1 - xx - yy) * s.z, 0);
+			m[3] = vec4(t, 1);
+		}
+
+		//the same, four nodes a lane each
+		void buildLocals(const unsigned int* n)
+		{
+			const quat& q0 = nodes.rotations[n[0]];
+			const quat& q1 = nodes.rotations[n[1]];
+			const quat& q2 = nodes.rotations[n[2]];
+			const quat& q3 = nodes.rotations[n[3]];
+			__m128 x = _mm_setr_ps(q0.x, q1.x, q2.x, q3.x);
+			__m128 y = _mm_setr_ps(q0.y, q1.y, q2.y, q3.y);
+			__m128 z = _mm_setr_ps(q0.z, q1.z, q2.z, q3.z);
+			__m128 w = _mm_setr_ps(q0.w, q1.w, q2.w, q3.w);
+			__m128 k = _mm_div_ps(_mm_set1_ps(2.0f), _mm_add_ps(_mm_add_ps(_mm_mul_ps(x, x), _mm_mul_ps(y, y)), _mm_add_ps(_mm_mul_ps(z, z), _mm_mul_ps(w, w))));
+
+			__m128 kx = _mm_mul_ps(x, k), ky = _mm_mul_ps(y, k), kz = _mm_mul_ps(z, k);
+			__m128 xx = _mm_mul_ps(x, kx), yy = _mm_mul_ps(y, ky), zz = _mm_mul_ps(z, kz);
+			__m128 xy = _mm_mul_ps(x, ky), xz = _mm_mul_ps(x, kz), yz = _mm_mul_ps(y, kz);
+			__m128 wx = _mm_mul_ps(w, kx), wy = _mm_mul_ps(w, ky), wz = _mm_mul_ps(w, kz);
+			__m128 one = _mm_set1_ps(1.0f);
+
+			const vec3* s[4] = { &nodes.scales[n[0]], &nodes.scales[n[1]], &nodes.scales[n[2]], &nodes.scales[n[3]] };
+			const vec3* t[4] = { &nodes.translations[n[0]], &nodes.translations[n[1]], &nodes.translations[n[2]], &nodes.translations[n[3]] };
+			__m128 sx = _mm_setr_ps(s[0]->x, s[1]->x, s[2]->x, s[3]->x);
+			__m128 sy = _mm_setr_ps(s[0]->y, s[1]->y, s[2]->y, s[3]->y);
+			__m128 sz = _mm_setr_ps(s[0]->z, s[1]->z, s[2]->z, s[3]->z);
+
+			//one row of a column per register, lane i is node i, transposing turns them into whole columns per node
+			__m128 columns[4][4];
+			columns[0][0] = _mm_mul_ps(_mm_sub_ps(one, _mm_add_ps(yy, zz)), sx);
+			columns[0][1] = _mm_mul_ps(_mm_add_ps(xy, wz), sx);
+			columns[0][2] = _mm_mul_ps(_mm_sub_ps(xz, wy), sx);
+			columns[0][3] = _mm_setzero_ps();
+			columns[1][0] = _mm_mul_ps(_mm_sub_ps(xy, wz), sy);
+			columns[1][1] = _mm_mul_ps(_mm_sub_ps(one, _mm_add_ps(xx, zz)), sy);
+			columns[1][2] = _mm_mul_ps(_mm_add_ps(yz, wx), sy);
+			columns[1][3] = _mm_setzero_ps();
+			columns[2][0] = _mm_mul_ps(_mm_add_ps(xz, wy), sz);
+			columns[2][1] = _mm_mul_ps(_mm_sub_ps(yz, wx), sz);
+			columns[2][2] = _mm_mul_ps(_mm_sub_ps(one, _mm_add_ps(xx, yy)), sz);
+			columns[2][3] = _mm_setzero_ps();
+			columns[3][0] = _mm_setr_ps(t[0]->x, t[1]->x, t[2]->x, t[3]->x);
+			columns[3][1] = _mm_setr_ps(t[0]->y, t[1]->y, t[2]->y, t[3]->y);
+			columns[3][2] = _mm_setr_ps(t[0]->z, t[1]->z, t[2]->z, t[3]->z);
+			columns[3][3] = one;
+
+			for (int c = 0; c < 4; c++)
+			{
+				_MM_TRANSPOSE4_PS(columns[c][0], columns[c][1], columns[c][2], columns[c][3]);
+				for (int i = 0; i < 4; i++)
+				{
+					_mm_storeu_ps(&nodes.locals[n[i]][c][0], columns[c][i]);
+				}
+			}
+		}
+
+		//out = a * b, column major
+		void multiply(const mat4& a, const mat4& b, mat4& out)
+		{
+			__m128 a0 = _mm_loadu_ps(&a[0][0]);
+			__m128 a1 = _mm_loadu_ps(&a[1][0]);
+			__m128 a2 = _mm_loadu_ps(&a[2][0]);
+			__m128 a3 = _mm_loadu_ps(&a[3][0]);
+			for (int c = 0; c < 4; c++)
+			{
+				__m128 column = _mm_add_ps(
+					_mm_add_ps(_mm_mul_ps(a0, _mm_set1_ps(b[c][0])), _mm_mul_ps(a1, _mm_set1_ps(b[c][1]))),
+					_mm_add_ps(_mm_mul_ps(a2, _mm_set1_ps(b[c][2])), _mm_mul_ps(a3, _mm_set1_ps(b[c][3]))));
+				_mm_storeu_ps(&out[c][0], column);
+			}
+		}
+
+		//true if the world matrix was rebuilt, the parent must be up to date
+		bool buildWorld(unsigned int n)
+		{
+			int parent = nodes.parents[n];
+			bool parentMoved = parent != TransformHierarchy::NO_PARENT && nodes.parentVersions[n] != nodes.versions[parent];
+			if (!(nodes.flags[n] & WORLD_DIRTY) && !parentMoved)
+			{
+				return false;
+			}
+			if (parent != TransformHierarchy::NO_PARENT)
+			{
+				multiply(nodes.worlds[parent], nodes.locals[n], nodes.worlds[n]);
+				nodes.parentVersions[n] = nodes.versions[parent];
+			}
+			else
+			{
+				nodes.worlds[n] = nodes.locals[n];
+			}
+			nodes.flags[n] &= ~WORLD_DIRTY;
+			nodes.versions[n]++;
+			return true;
+		}
+
+		void resolve(unsigned int n)
+		{
+			if (nodes.parents[n] != TransformHierarchy::NO_PARENT)
+			{
+				resolve(nodes.parents[n]);
+			}
+			if (nodes.flags[n] & LOCAL_DIRTY)
+			{
+				buildLocal(n);
+				nodes.flags[n] &= ~LOCAL_DIRTY;
+			}
+			buildWorld(n);
+		}
+
+		void sortOrder()
+		{
+			//by depth, so parents always come first
+			vector<unsigned int> depths(nodes.flags.size(), 0);
+			unsigned int deepest = 0;
+			for (unsigned int n = 0; n < nodes.flags.size(); n++)
+			{
+				if (!(nodes.flags[n] & ALIVE))
+				{
+					continue;
+				}
+				for (int p = nodes.parents[n]; p != TransformHierarchy::NO_PARENT; p = nodes.parents[p])
+				{
+					depths[n]++;
+				}
+				deepest = glm::max(deepest, depths[n]);
+			}
+
+			nodes.order.clear();
+			for (unsigned int depth = 0; depth <= deepest; depth++)
+			{
+				for (unsigned int n = 0; n < nodes.flags.size(); n++)
+				{
+					if ((nodes.flags[n] & ALIVE) && depths[n] == depth)
+					{
+						nodes.order.push_back(n);
+					}
+				}
+			}
+			nodes.orderDirty = false;
+		}
+	}
+
+	unsigned int TransformHierarchy::create()
+	{
+		checkThread();
+		unsigned int n;
+		if (!nodes.freeNodes.empty())
+		{
+			n = nodes.freeNodes.back();
+			nodes.freeNodes.pop_back();
+		}
+		else
+		{
+			n = nodes.flags.size();
+			nodes.translations.emplace_back();
+			nodes.rotations.emplace_back();
+			nodes.scales.emplace_back();
+			nodes.locals.emplace_back();
+			nodes.worlds.emplace_back();
+			nodes.parents.emplace_back();
+			nodes.children.emplace_back();
+			nodes.versions.emplace_back(0);
+			nodes.parentVersions.emplace_back(0);
+			nodes.flags.emplace_back(0);
+		}
+
+		nodes.translations[n] = vec3();
+		nodes.rotations[n] = quat(1, 0, 0, 0);
+		nodes.scales[n] = vec3(1, 1, 1);
+		nodes.locals[n] = mat4();
+		nodes.worlds[n] = mat4();
+		nodes.parents[n] = NO_PARENT;
+		//keeps counting up through reuse, so nothing that remembered the old node mistakes the new one for it
+		nodes.versions[n]++;
+		nodes.flags[n] = ALIVE;
+		nodes.orderDirty = true;
+		return n;
+	}
+
+	void TransformHierarchy::destroy(unsigned int node)
+	{
+		checkThread();
+		for (unsigned int child : nodes.children[node])
+		{
+			nodes.parents[child] = NO_PARENT;
+			nodes.flags[child] |= WORLD_DIRTY;
+		}
+		nodes.children[node].clear();
+		detach(node);
+		nodes.flags[node] = 0;
+		nodes.freeNodes.push_back(node);
+		nodes.orderDirty = true;
+	}
+
+	bool TransformHierarchy::setParent(unsigned int node, int parent)
+	{
+		checkThread();
+		for (int p = parent; p != NO_PARENT; p = nodes.parents[p])
+		{
+			if (p == (int)node)
+			{
+				std::cout << "A transform can't be parented to itself or its own descendant!" << std::endl;
+				return false;
+			}
+		}
+		if (nodes.parents[node] != parent)
+		{
+			detach(node);
+			if (parent != NO_PARENT)
+			{
+				nodes.children[parent].push_back(node);
+			}
+			nodes.parents[node] = parent;
+			nodes.flags[node] |= WORLD_DIRTY;
+			nodes.orderDirty = true;
+		}
+		return true;
+	}
+
+	int TransformHierarchy::getParent(unsigned int node)
+	{
+		checkThread();
+		return nodes.parents[node];
+	}
+
+	void TransformHierarchy::setTranslation(unsigned int node, const vec3& translation)
+	{
+		checkThread();
+		nodes.translations[node] = translation;
+		nodes.flags[node] |= LOCAL_DIRTY | WORLD_DIRTY;
+	}
+
+	void TransformHierarchy::setRotation(unsigned int node, const quat& rotation)
+	{
+		checkThread();
+		nodes.rotations[node] = rotation;
+		nodes.flags[node] |= LOCAL_DIRTY | WORLD_DIRTY;
+	}
+
+	void TransformHierarchy::setScale(unsigned int node, const vec3& scale)
+	{
+		checkThread();
+		nodes.scales[node] = scale;
+		nodes.flags[node] |= LOCAL_DIRTY | WORLD_DIRTY;
+	}
+
+	void TransformHierarchy::setLocal(unsigned int node, const mat4& local)
+	{
+		checkThread();
+		nodes.locals[node] = local;
+		nodes.flags[node] = (nodes.flags[node] & ~LOCAL_DIRTY) | WORLD_DIRTY;
+	}
+
+	const mat4& TransformHierarchy::getWorld(unsigned int node)
+	{
+		checkThread();
+		resolve(node);
+		return nodes.worlds[node];
+	}
+
+	unsigned int TransformHierarchy::getVersion(unsigned int node)
+	{
+		checkThread();
+		resolve(node);
+		return nodes.versions[node];
+	}
+
+	void TransformHierarchy::update()
+	{
+		checkThread();
+		if (nodes.orderDirty)
+		{
+			sortOrder();
+		}
+
+		nodes.localDirty.clear();
+		for (unsigned int i = 0; i < nodes.order.size(); i++)
+		{
+			unsigned int n = nodes.order[i];
+			if (nodes.flags[n] & LOCAL_DIRTY)
+			{
+				nodes.localDirty.push_back(n);
+				nodes.flags[n] &= ~LOCAL_DIRTY;
+			}
+		}
+		unsigned int count = nodes.localDirty.size();
+		unsigned int built = 0;
+		for (; built + 4 <= count; built += 4)
+		{
+			buildLocals(&nodes.localDirty[built]);
+		}
+		for (; built < count; built++)
+		{
+			buildLocal(nodes.localDirty[built]);
+		}
+
+		nodes.updated = 0;
+		for (unsigned int i = 0; i < nodes.order.size(); i++)
+		{
+			if (buildWorld(nodes.order[i]))
+			{
+				nodes.updated++;
+			}
+		}
+	}
+
+	unsigned int TransformHierarchy::getUpdatedCount()
+	{
+		checkThread();
+		return nodes.updated;
+	}
+
+}
@@ -0,0 +1,41 @@
+#pragma once
+
+#include "RenderResource.h"
+#include <glm/gtx/quaternion.hpp>
+
+namespace ginkgo {
+
+	//every Transform's data in dense arrays, owned by the render thread, other threads trip an assert in debug builds
+	//update rebuilds all the matrices that changed once a frame, four local matrices at a time straight from the quaternions,
+	//then the world matrices parents first, a child only multiplies when it or its parent actually moved
+	//getWorld resolves a single node on demand, for anything asked between updates
+	class TransformHierarchy
+	{
+	public:
+		static const int NO_PARENT = -1;
+
+		static unsigned int create();
+		//children are detached and keep their local matrix
+		static void destroy(unsigned int node);
+
+		//false (and nothing changes) if parent is node or one of its descendants
+		static bool setParent(unsigned int node, int parent);
+		static int getParent(unsigned int node);
+
+		static void setTranslation(unsigned int node, const vec3& translation);
+		static void setRotation(unsigned int node, const quat& rotation);
+		static void setScale(unsigned int node, const vec3& scale);
+		//replaces the local matrix until the next translation, rotation or scale
+		static void setLocal(unsigned int node, const mat4& local);
+
+		//valid until the node is destroyed, nodes never move
+		static const mat4& getWorld(unsigned int node);
+		//changes whenever getWorld would return something new, never 0
+		static unsigned int getVersion(unsigned int node);
+
+		static void update();
+		//world matrices rebuilt by the last update
+		static unsigned int getUpdatedCount();
+	};
+
+}
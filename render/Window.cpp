@@ -1,6 +1,7 @@
 #include <iostream>
 
 #include "Window.h"
+#include "GLState.h"
 
 namespace ginkgo {
 	Window::Window(const char* name, int width, int height, const vec4& clear_color, bool isFullScreen)
@@ -70,7 +71,7 @@ namespace ginkgo {
 		//glEnable(GL_CULL_FACE);	//Not drawing unnecessary front and back stuff //TBB
 		//glEnable(GL_DEPTH_TEST); //Z component for depth //TBB //already
 		//glDepthFunc(GL_LESS); //already
-		glEnable(GL_DEPTH_CLAMP);//Depth clamp so camera won't be halfway inside or outside //TBB //already
+		GLState::enable(GL_DEPTH_CLAMP);//Depth clamp so camera won't be halfway inside or outside //TBB //already
 		//glEnable(GL_FRAMEBUFFER_SRGB); //More gamma correction, all other colors are already exponential, it does it for us
 		//Wireframe
 		//glPolygonMode(GL_FRONT_AND_BACK, GL_LINE);